@@ -8,6 +8,7 @@
 #include <nlohmann/json.hpp>
 #include <iostream>
 #include "light_utils.hpp" 
+#include "hash_utils.hpp"
 
 
 Asset::Asset(std::shared_ptr<AssetInfo> info_,
@@ -123,6 +124,25 @@ SDL_Texture* Asset::get_current_frame() const {
     return nullptr;
 }
 
+SDL_Texture* Asset::get_current_frame_lod(int dst_w, int dst_h) const {
+    if (custom_frames.count(current_animation)) return get_current_frame();
+
+    auto iti = info->animations.find(current_animation);
+    if (iti != info->animations.end())
+        return iti->second.get_frame_lod(current_frame_index, dst_w, dst_h);
+
+    return nullptr;
+}
+
+SDL_Texture* Asset::get_current_silhouette() const {
+    if (custom_frames.count(current_animation)) return nullptr;
+
+    auto iti = info->animations.find(current_animation);
+    if (iti != info->animations.end())
+        return iti->second.get_silhouette(current_frame_index);
+
+    return nullptr;
+}
 
 void Asset::set_remove(){
     remove = true;
@@ -258,11 +278,24 @@ void Asset::set_flip() {
     flipped = (dist(rng) == 1);
 }
 
-void Asset::set_final_texture(SDL_Texture* tex) {
-    if (final_texture) SDL_DestroyTexture(final_texture);
-    final_texture = tex;
-    if (tex) {
-        SDL_QueryTexture(tex, nullptr, nullptr, &cached_w, &cached_h);
+void Asset::set_final_texture(std::shared_ptr<SDL_Texture> tex,
+                              std::uint64_t key,
+                              int lighting_state) {
+    if (!tex) {
+        previous_final_texture.reset();
+        final_texture_fade = 1.0f;
+    } else if (final_texture && final_texture != tex &&
+               lighting_state >= 0 && final_texture_state >= 0 &&
+               lighting_state != final_texture_state) {
+        previous_final_texture = std::move(final_texture);
+        final_texture_fade = 0.0f;
+    }
+
+    final_texture = std::move(tex);
+    final_texture_key = final_texture ? key : 0;
+    final_texture_state = final_texture ? lighting_state : -1;
+    if (final_texture) {
+        SDL_QueryTexture(final_texture.get(), nullptr, nullptr, &cached_w, &cached_h);
     } else {
         cached_w = cached_h = 0;
     }
@@ -270,7 +303,39 @@ void Asset::set_final_texture(SDL_Texture* tex) {
 }
 
 SDL_Texture* Asset::get_final_texture() const {
-    return final_texture;
+    return final_texture.get();
+}
+
+SDL_Texture* Asset::get_previous_final_texture() const {
+    return previous_final_texture.get();
+}
+
+float Asset::advance_final_texture_fade(float step, int lighting_state, float state_fade) {
+    if (!previous_final_texture) return 1.0f;
+    float fade = final_texture_fade + step;
+    if (final_texture_state == lighting_state) fade = std::max(fade, state_fade);
+    final_texture_fade = std::min(1.0f, fade);
+    if (final_texture_fade >= 1.0f) previous_final_texture.reset();
+    return final_texture_fade;
+}
+
+void Asset::set_state_variant(std::shared_ptr<SDL_Texture> tex, std::uint64_t key) {
+    state_variant = std::move(tex);
+    state_variant_key = state_variant ? key : 0;
+}
+
+std::uint64_t Asset::get_state_variant_key() const {
+    return state_variant_key;
+}
+
+std::shared_ptr<SDL_Texture> Asset::take_state_variant(std::uint64_t key) {
+    if (!state_variant || state_variant_key != key) return nullptr;
+    state_variant_key = 0;
+    return std::move(state_variant);
+}
+
+std::uint64_t Asset::get_final_texture_key() const {
+    return final_texture_key;
 }
 
 int Asset::get_shading_group() const {
@@ -291,10 +356,17 @@ void Asset::add_static_light_source(LightSource* light, int world_x, int world_y
 
     StaticLight sl;
     sl.source = light;
+    sl.owner = owner;
     sl.offset_x = world_x - pos_X;
     sl.offset_y = world_y - pos_Y;
     sl.alpha_percentage = LightUtils::calculate_static_alpha_percentage(this, owner);
     static_lights.push_back(sl);
+
+    if (static_light_signature == 0) static_light_signature = HashUtils::SEED;
+    HashUtils::combine_ptr(static_light_signature, light);
+    HashUtils::combine(static_light_signature, (std::uint64_t(std::uint32_t(sl.offset_x)) << 32) |
+                                               std::uint32_t(sl.offset_y));
+    HashUtils::combine(static_light_signature, static_cast<std::uint64_t>(sl.alpha_percentage * 1024.0));
 }
 
 void Asset::set_render_player_light(bool value) {
@@ -336,9 +408,13 @@ Area Asset::get_area(const std::string& name) const {
 }
 
 void Asset::deactivate() {
-    if (final_texture) {
-        SDL_DestroyTexture(final_texture);
-        final_texture = nullptr;
-    }
+    final_texture.reset();
+    final_texture_key = 0;
+    final_texture_state = -1;
+    previous_final_texture.reset();
+    final_texture_fade = 1.0f;
+    state_variant.reset();
+    state_variant_key = 0;
+    static_light_mask.reset();
 }
 
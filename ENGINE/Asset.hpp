@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include <unordered_map>
 #include <SDL.h>
 #include "area.hpp"
@@ -13,13 +14,31 @@
 #include "asset_spawn_planner.hpp"
 #include "light_source.hpp"
 
+class Asset;
+
 struct StaticLight {
     LightSource* source = nullptr;
+    const Asset* owner = nullptr;   // asset carrying the light; seeds its flicker
     int offset_x = 0;
     int offset_y = 0;
     double alpha_percentage = 1.0;
 };
 
+// A sprite folded into another asset by AssetLoader::mergeDistantAssets.
+struct MergedSprite {
+    std::shared_ptr<AssetInfo> info;   // keeps frame alive
+    SDL_Texture* frame = nullptr;
+    int x = 0;                         // world position of the bottom centre
+    int y = 0;
+    int w = 0;
+    int h = 0;
+    bool flipped = false;
+    double tint_factor = 1.0;          // member's alpha_percentage (tint strength, see RenderAsset)
+    bool shaded = false;               // member's has_shading
+    SDL_Texture* silhouette = nullptr; // shading mask base of frame, if built
+    int z_index = 0;
+};
+
 class Asset {
 public:
     Area get_area(const std::string& name) const;
@@ -36,6 +55,9 @@ public:
     void change_animation(const std::string& name);
 
     SDL_Texture* get_current_frame() const;
+    SDL_Texture* get_current_silhouette() const;
+    // Current frame, or its smallest mip still covering dst_w x dst_h.
+    SDL_Texture* get_current_frame_lod(int dst_w, int dst_h) const;
 
     std::string get_current_animation() const;
     std::string get_type() const;
@@ -55,7 +77,29 @@ public:
     int get_shading_group() const;
 
     SDL_Texture* get_final_texture() const;
-    void set_final_texture(SDL_Texture* tex);
+    // key: hash of the lighting inputs the texture was baked from (see SceneRenderer).
+    // Final textures may be shared between instances through LitTextureCache.
+    // lighting_state: Global_Light_Source state of the bake; when it differs from
+    // the current texture's, the old texture is kept for a crossfade.
+    void set_final_texture(std::shared_ptr<SDL_Texture> tex,
+                           std::uint64_t key = 0,
+                           int lighting_state = -1);
+    std::uint64_t get_final_texture_key() const;
+
+    // Texture being faded out after a lighting-state step (nullptr if none).
+    SDL_Texture* get_previous_final_texture() const;
+    // Advances the crossfade by step and returns the new texture's weight (0..1);
+    // the previous texture is released once it reaches 1. A texture baked for
+    // lighting_state never lags behind that state's global crossfade
+    // state_fade, so it stays in step with passes that follow it directly.
+    float advance_final_texture_fade(float step, int lighting_state, float state_fade);
+
+    // Bake for the next lighting state, made ahead of the step so it can be
+    // swapped in (and crossfaded) without a regen.
+    void set_state_variant(std::shared_ptr<SDL_Texture> tex, std::uint64_t key);
+    std::uint64_t get_state_variant_key() const;
+    // Returns the variant if it was baked for key, and forgets it.
+    std::shared_ptr<SDL_Texture> take_state_variant(std::uint64_t key);
 
     Asset* parent = nullptr;
     std::shared_ptr<AssetInfo> info;
@@ -79,8 +123,19 @@ public:
     std::vector<Area> areas;
 
     std::vector<Asset*> children;
+    // Set on the asset left standing for a merged tile: every sprite of the
+    // tile, its own included, in draw order. Drawn through ImpostorTiles.
+    std::vector<MergedSprite> merged_sprites;
 
     std::vector<StaticLight> static_lights;
+    std::uint64_t static_light_signature = 0;   // hash of static_lights, for sharing bakes
+    // Half-resolution sum of the non-flickering static_lights, built lazily by
+    // RenderAsset for a frame size of static_light_mask_w x static_light_mask_h
+    // at brightness static_light_mask_alpha.
+    std::shared_ptr<SDL_Texture> static_light_mask;
+    int static_light_mask_w = 0;
+    int static_light_mask_h = 0;
+    int static_light_mask_alpha = -1;
     int gradient_shadow = 0;
     int depth = 0;
     bool has_shading = false;
@@ -105,7 +160,13 @@ private:
     int shading_group = 0;
     bool shading_group_set = false;
 
-    SDL_Texture* final_texture = nullptr;
+    std::shared_ptr<SDL_Texture> final_texture;
+    std::uint64_t final_texture_key = 0;
+    int final_texture_state = -1;
+    std::shared_ptr<SDL_Texture> previous_final_texture;
+    float final_texture_fade = 1.0f;
+    std::shared_ptr<SDL_Texture> state_variant;
+    std::uint64_t state_variant_key = 0;
     std::unordered_map<std::string, std::vector<SDL_Texture*>> custom_frames;
 };
 
@@ -101,7 +101,9 @@ Assets::Assets(std::vector<Asset>&& loaded,
     }
 
     std::cout << "[Assets] All static sources set.\n";
+    light_registry.build(all, player);
     set_player_light_render();
+    activeManager.buildStaticChunks();
     activeManager.updateVisibility(player, screen_center_x, screen_center_y);
     activeManager.sortByZIndex();
 
@@ -241,4 +243,9 @@ void Assets::remove(Asset* asset) {
 
     // Call destructor explicitly
     asset->~Asset();
+
+    // erase() moved the remaining assets; registry entries and static chunks
+    // point into `all`
+    light_registry.build(all, player);
+    activeManager.buildStaticChunks();
 }
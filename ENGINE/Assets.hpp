@@ -6,6 +6,7 @@
 #include "area.hpp"
 #include "controls_manager.hpp"  // ✅ Ensure this is included
 #include "active_assets_manager.hpp"
+#include "light_registry.hpp"
 
 #include <vector>
 #include <unordered_set>
@@ -35,8 +36,10 @@ public:
     std::vector<Asset>  all;
     std::vector<Asset*> closest_assets;
     Asset*              player = nullptr;
+    LightRegistry       light_registry;      // lights of every non-player asset
     int                 visible_count = 0;
     view& getView() { return window; }
+    const ActiveAssetsManager& getActiveManager() const { return activeManager; }
     void remove(Asset* asset);
 
 private:
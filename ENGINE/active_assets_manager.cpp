@@ -1,9 +1,17 @@
 #include "active_assets_manager.hpp"
 #include <algorithm>
 #include <cmath>
+#include <iostream>
 #include <limits>
 #include <unordered_set>
 
+namespace {
+int chunk_floor(int v) {
+    const int s = ActiveAssetsManager::STATIC_CHUNK_SIZE;
+    return v >= 0 ? v / s : -((-v + s - 1) / s);
+}
+}
+
 ActiveAssetsManager::ActiveAssetsManager(int screen_width, int screen_height, view& v)
     : view_(v),
       screen_width_(screen_width),
@@ -133,3 +141,75 @@ void ActiveAssetsManager::sortByZIndex()
                   return A < B;
               });
 }
+
+bool ActiveAssetsManager::isStaticScenery(const Asset& a)
+{
+    if (!a.info || a.info->type == "Player") return false;
+    // Drawn through ImpostorTiles.
+    if (!a.merged_sprites.empty()) return false;
+    if (!a.info->orbital_light_sources.empty()) return false;
+    for (const auto& sl : a.static_lights) {
+        if (sl.source && sl.source->flicker > 0) return false;
+    }
+    return true;
+}
+
+bool ActiveAssetsManager::chunkSpan(const Asset& a, int& cx0, int& cy0, int& cx1, int& cy1)
+{
+    SDL_Texture* frame = a.get_current_frame();
+    if (!frame) return false;
+    int fw = 0, fh = 0;
+    SDL_QueryTexture(frame, nullptr, nullptr, &fw, &fh);
+    if (fw <= 0 || fh <= 0) return false;
+
+    // Sprites hang from their bottom centre (see SceneRenderer).
+    const int x0 = a.pos_X - fw / 2;
+    const int y0 = a.pos_Y - fh;
+    cx0 = chunk_floor(x0);
+    cy0 = chunk_floor(y0);
+    cx1 = chunk_floor(x0 + fw - 1);
+    cy1 = chunk_floor(y0 + fh - 1);
+    return true;
+}
+
+bool ActiveAssetsManager::inStaticChunks(const Asset& a, int cx0, int cy0, int cx1, int cy1) const
+{
+    auto it = static_spans_.find(&a);
+    if (it == static_spans_.end()) return false;
+    const SDL_Rect& r = it->second;
+    return r.x == cx0 && r.y == cy0 && r.x + r.w - 1 == cx1 && r.y + r.h - 1 == cy1;
+}
+
+void ActiveAssetsManager::buildStaticChunks()
+{
+    static_chunks_.clear();
+    static_spans_.clear();
+    if (!all_assets_) return;
+
+    std::size_t members = 0;
+    for (Asset& a : *all_assets_) {
+        if (!isStaticScenery(a)) continue;
+        int cx0, cy0, cx1, cy1;
+        if (!chunkSpan(a, cx0, cy0, cx1, cy1)) continue;
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                static_chunks_[makeKey(cx, cy)].push_back(&a);
+            }
+        }
+        static_spans_[&a] = SDL_Rect{ cx0, cy0, cx1 - cx0 + 1, cy1 - cy0 + 1 };
+        ++members;
+    }
+
+    for (auto& [key, list] : static_chunks_) {
+        std::sort(list.begin(), list.end(),
+                  [](Asset* A, Asset* B) {
+                      if (A->z_index != B->z_index) return A->z_index < B->z_index;
+                      if (A->pos_Y != B->pos_Y)     return A->pos_Y < B->pos_Y;
+                      if (A->pos_X != B->pos_X)     return A->pos_X < B->pos_X;
+                      return A < B;
+                  });
+    }
+
+    std::cout << "[ActiveAssetsManager] " << members << " static assets in "
+              << static_chunks_.size() << " chunks\n";
+}
@@ -8,6 +8,10 @@
 class ActiveAssetsManager {
 public:
     using ChunkKey = std::uint64_t;
+    using ChunkMap = std::unordered_map<ChunkKey, std::vector<Asset*>>;
+
+    // Side of a static chunk, in world pixels.
+    static constexpr int STATIC_CHUNK_SIZE = 512;
 
     ActiveAssetsManager(int screen_width, int screen_height, view& v);
 
@@ -27,6 +31,30 @@ public:
     std::vector<Asset*>& getActive()   { return active_assets_; }
     std::vector<Asset*>& getClosest()  { return closest_assets_; }
 
+    // Groups static scenery by the chunks its sprite covers. Needs static
+    // lights assigned (Assets::set_static_sources) first.
+    void buildStaticChunks();
+    // Assets whose sprite covers each chunk, in draw order. An asset spanning
+    // several chunks is listed in each of them.
+    const ChunkMap& getStaticChunks() const { return static_chunks_; }
+    // True if a was grouped into exactly the chunks cx0..cx1, cy0..cy1, i.e.
+    // it is static scenery and its sprite still covers what was grouped.
+    bool inStaticChunks(const Asset& a, int cx0, int cy0, int cx1, int cy1) const;
+
+    // Scenery that can be baked into a chunk while it is not animating and
+    // no player light reaches it: it never moves and its lighting only
+    // changes with the global lighting state.
+    static bool isStaticScenery(const Asset& a);
+    // Chunks covered by the current frame of a, inclusive. False if it has none.
+    static bool chunkSpan(const Asset& a, int& cx0, int& cy0, int& cx1, int& cy1);
+
+    static constexpr ChunkKey makeKey(int cx, int cy) {
+        return (static_cast<ChunkKey>(static_cast<uint32_t>(cx)) << 32) |
+                static_cast<uint32_t>(cy);
+    }
+    static constexpr int keyX(ChunkKey key) { return static_cast<int32_t>(key >> 32); }
+    static constexpr int keyY(ChunkKey key) { return static_cast<int32_t>(key & 0xffffffffu); }
+
 private:
     view& view_;
     int screen_width_;
@@ -37,15 +65,10 @@ private:
     std::vector<Asset*> active_assets_;
     std::vector<Asset*> closest_assets_;
 
-    std::unordered_map<ChunkKey, std::vector<Asset*>> static_chunks_;
-    std::unordered_map<ChunkKey, std::vector<Asset*>> dynamic_chunks_;
+    ChunkMap static_chunks_;
+    ChunkMap dynamic_chunks_;
+    std::unordered_map<const Asset*, SDL_Rect> static_spans_;   // in chunks
 
-    static constexpr ChunkKey makeKey(int cx, int cy) {
-        return (static_cast<ChunkKey>(static_cast<uint32_t>(cx)) << 32) |
-                static_cast<uint32_t>(cy);
-    }
-
-    void buildStaticChunks();
     void updateDynamicChunks();
     void sortByDistance(int cx, int cy);
     void activate(Asset* asset);
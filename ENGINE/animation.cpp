@@ -2,12 +2,57 @@
 
 #include "Animation.hpp"
 #include "cache_manager.hpp"
+#include "pixel_kernels.hpp"
 #include <SDL_image.h>
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <iostream>
 
 namespace fs = std::filesystem;
 
+// Mips stop once the long side is this small or after MAX_MIP_LEVELS halvings.
+static constexpr int MIN_MIP_SIZE   = 32;
+static constexpr int MAX_MIP_LEVELS = 5;
+
+static int mip_level_count(int w, int h) {
+    int levels = 0;
+    while (levels < MAX_MIP_LEVELS && std::max(w, h) > MIN_MIP_SIZE) {
+        w = std::max(1, (w + 1) / 2);
+        h = std::max(1, (h + 1) / 2);
+        ++levels;
+    }
+    return levels;
+}
+
+static std::string mip_file(const std::string& cache_folder, int frame_index, int level) {
+    return cache_folder + "/" + std::to_string(frame_index) + "_mip" + std::to_string(level) + ".bmp";
+}
+
+// Reproduces what RenderAsset used to draw per regen: the frame color-modded to
+// black over a (255,255,255,0) clear, i.e. rgb = 255 - alpha, alpha = alpha.
+static SDL_Surface* make_silhouette_surface(SDL_Surface* src) {
+    SDL_Surface* sil = SDL_ConvertSurfaceFormat(src, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!sil) return nullptr;
+
+    if (SDL_LockSurface(sil) != 0) {
+        SDL_FreeSurface(sil);
+        return nullptr;
+    }
+    for (int y = 0; y < sil->h; ++y) {
+        Uint8* row = static_cast<Uint8*>(sil->pixels) + y * sil->pitch;
+        for (int x = 0; x < sil->w; ++x) {
+            Uint8* px = row + x * 4;
+            const Uint8 inv = static_cast<Uint8>(255 - px[3]);
+            px[0] = inv;
+            px[1] = inv;
+            px[2] = inv;
+        }
+    }
+    SDL_UnlockSurface(sil);
+    return sil;
+}
+
 Animation::Animation() = default;
 
 void Animation::load(const std::string& trigger,
@@ -21,7 +66,8 @@ void Animation::load(const std::string& trigger,
                      int& scaled_sprite_w,
                      int& scaled_sprite_h,
                      int& original_canvas_width,
-                     int& original_canvas_height)
+                     int& original_canvas_height,
+                     bool build_silhouettes)
 {
     CacheManager cache;
     std::string src_folder   = dir_path + "/" + anim_json["frames_path"].get<std::string>();
@@ -56,6 +102,9 @@ void Animation::load(const std::string& trigger,
             use_cache = true;
         }
     }
+    const int expected_mips = mip_level_count(static_cast<int>(orig_w * scale_factor + 0.5f),
+                                              static_cast<int>(orig_h * scale_factor + 0.5f));
+    const bool mips_cached = use_cache && meta.value("mip_levels", -1) == expected_mips;
 
     std::vector<SDL_Surface*> surfaces;
     if (use_cache) {
@@ -89,7 +138,20 @@ void Animation::load(const std::string& trigger,
         new_meta["original_width"]  = orig_w;
         new_meta["original_height"] = orig_h;
         new_meta["blend_mode"]      = int(blendmode);
+        new_meta["mip_levels"]      = expected_mips;
         cache.save_metadata(meta_file, new_meta);
+    } else if (!mips_cached) {
+        // Cache predates mips: they are written below, then recorded.
+        meta["mip_levels"] = expected_mips;
+        cache.save_metadata(meta_file, meta);
+    }
+
+    renderer_     = renderer;
+    blendmode_    = blendmode;
+    cache_folder_ = cache_folder;
+    if (!surfaces.empty()) {
+        frame_w_ = surfaces[0]->w;
+        frame_h_ = surfaces[0]->h;
     }
 
     on_end           = anim_json.value("on_end", "");
@@ -98,15 +160,28 @@ void Animation::load(const std::string& trigger,
     loop             = anim_json.value("loop", true);
     lock_until_done  = anim_json.value("lock_until_done", false);
 
-    for (SDL_Surface* surf : surfaces) {
+    for (size_t i = 0; i < surfaces.size(); ++i) {
+        SDL_Surface* surf = surfaces[i];
         SDL_Texture* tex = cache.surface_to_texture(renderer, surf);
-        SDL_FreeSurface(surf);
+        SDL_Texture* sil_tex = nullptr;
+        if (tex && build_silhouettes) {
+            if (SDL_Surface* sil = make_silhouette_surface(surf)) {
+                sil_tex = cache.surface_to_texture(renderer, sil);
+                SDL_FreeSurface(sil);
+                // Copied verbatim into the mask target.
+                if (sil_tex) SDL_SetTextureBlendMode(sil_tex, SDL_BLENDMODE_NONE);
+            }
+        }
         if (!tex) {
+            SDL_FreeSurface(surf);
             std::cerr << "[Animation] Failed to create texture for '" << trigger << "'\n";
             continue;
         }
         SDL_SetTextureBlendMode(tex, blendmode);
         frames.push_back(tex);
+        silhouettes.push_back(sil_tex);
+        build_mips(surf, static_cast<int>(i), mips_cached);
+        SDL_FreeSurface(surf);
     }
 
     if (trigger == "default" && !frames.empty()) {
@@ -119,6 +194,121 @@ SDL_Texture* Animation::get_frame(int index) const {
     return frames[index];
 }
 
+void Animation::build_mips(SDL_Surface* frame, int frame_index, bool from_cache) {
+    std::vector<MipLevel> chain;
+    const int levels = mip_level_count(frame->w, frame->h);
+    CacheManager cache;
+
+    // Cached levels are only checked for here; get_frame_lod loads them.
+    if (from_cache) {
+        std::error_code ec;
+        bool complete = true;
+        for (int level = 1; level <= levels && complete; ++level) {
+            complete = fs::exists(mip_file(cache_folder_, frame_index, level), ec);
+        }
+        if (complete) {
+            chain.resize(levels);
+            for (MipLevel& m : chain) m.file_index = frame_index;
+            mips_.push_back(std::move(chain));
+            return;
+        }
+    }
+
+    std::vector<Uint8> rgba;
+    if (!PixelKernels::unpack_surface(frame, rgba)) {
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(frame, SDL_PIXELFORMAT_RGBA32, 0);
+        const bool ok = converted && PixelKernels::unpack_surface(converted, rgba);
+        if (converted) SDL_FreeSurface(converted);
+        if (!ok) {
+            mips_.push_back({});
+            return;
+        }
+    }
+
+    int w = frame->w, h = frame->h;
+    std::vector<Uint8> half;
+    for (int level = 1; level <= levels; ++level) {
+        int hw = 0, hh = 0;
+        PixelKernels::downsample_2x(rgba.data(), w, h, half, hw, hh);
+        SDL_Surface* s = SDL_CreateRGBSurfaceWithFormat(0, hw, hh, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!s) break;
+        PixelKernels::pack_surface(half, s);
+        MipLevel m;
+        m.file_index = frame_index;
+        if (cache.save_surface_as_png(s, mip_file(cache_folder_, frame_index, level))) {
+            SDL_FreeSurface(s);
+        } else {
+            m.surface = s;
+        }
+        chain.push_back(m);
+        rgba.swap(half);
+        w = hw;
+        h = hh;
+    }
+    mips_.push_back(std::move(chain));
+}
+
+SDL_Texture* Animation::get_frame_lod(int index, int dst_w, int dst_h) const {
+    SDL_Texture* base = get_frame(index);
+    if (!base || index >= static_cast<int>(mips_.size()) || mips_[index].empty()) return base;
+    if (dst_w <= 0 || dst_h <= 0 || frame_w_ <= 0 || frame_h_ <= 0) return base;
+
+    // Largest level whose size still covers the destination.
+    const float ratio = std::min(static_cast<float>(frame_w_) / dst_w,
+                                 static_cast<float>(frame_h_) / dst_h);
+    if (ratio < 2.0f) return base;
+    auto& chain = mips_[index];
+    const int level = std::min(static_cast<int>(std::log2(ratio)), static_cast<int>(chain.size()));
+
+    MipLevel& m = chain[level - 1];
+    if (!m.texture && !m.failed && renderer_) {
+        SDL_Surface* s = m.surface ? m.surface
+                                   : CacheManager::load_surface(mip_file(cache_folder_, m.file_index, level));
+        if (s) {
+            m.texture = SDL_CreateTextureFromSurface(renderer_, s);
+            if (m.texture) SDL_SetTextureBlendMode(m.texture, blendmode_);
+            if (s != m.surface) SDL_FreeSurface(s);
+        }
+        if (!m.texture) {
+            std::cerr << "[Animation] Failed to load mip " << level << " of frame " << index
+                      << " from '" << cache_folder_ << "'\n";
+            m.failed = true;
+        }
+    }
+    if (!m.texture) return base;
+    m.last_used_ms = SDL_GetTicks();
+    return m.texture;
+}
+
+int Animation::evict_mips(Uint32 now_ms, Uint32 max_idle_ms) {
+    int freed = 0;
+    for (auto& chain : mips_) {
+        for (auto& m : chain) {
+            if (m.texture && now_ms - m.last_used_ms > max_idle_ms) {
+                SDL_DestroyTexture(m.texture);
+                m.texture = nullptr;
+                ++freed;
+            }
+        }
+    }
+    return freed;
+}
+
+void Animation::destroy_mips() {
+    for (auto& chain : mips_) {
+        for (auto& m : chain) {
+            if (m.texture) SDL_DestroyTexture(m.texture);
+            if (m.surface) SDL_FreeSurface(m.surface);
+        }
+    }
+    mips_.clear();
+}
+
+SDL_Texture* Animation::get_silhouette(int index) const {
+    if (index < 0 || index >= static_cast<int>(silhouettes.size())) return nullptr;
+    return silhouettes[index];
+}
+
 bool Animation::advance(int& index, std::string& next_animation_name) const {
     if (frozen || frames.empty()) return false;
 
@@ -4,6 +4,7 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <SDL.h>
 #include <nlohmann/json.hpp>
 
@@ -22,9 +23,21 @@ public:
               int& scaled_sprite_w,
               int& scaled_sprite_h,
               int& original_canvas_width,
-              int& original_canvas_height);
+              int& original_canvas_height,
+              bool build_silhouettes);
 
     SDL_Texture* get_frame(int index) const;
+    SDL_Texture* get_silhouette(int index) const;
+    // Frame for drawing at dst_w x dst_h: the smallest mip that is still at
+    // least that large, loaded from the cache on first use. Falls back to
+    // get_frame.
+    SDL_Texture* get_frame_lod(int index, int dst_w, int dst_h) const;
+
+    // Destroys mip textures not drawn in the last max_idle_ms (they are
+    // loaded again on demand). Returns the number freed.
+    int evict_mips(Uint32 now_ms, Uint32 max_idle_ms);
+    // Frees all mip textures and surfaces (owner teardown, like frames).
+    void destroy_mips();
 
     bool advance(int& index, std::string& next_animation_name) const;
     void change(int& index, bool& static_flag) const;
@@ -34,6 +47,10 @@ public:
     bool is_static() const;
 
     std::vector<SDL_Texture*> frames;
+    // Per-frame shadow-mask base: black where the frame is opaque, white and
+    // transparent elsewhere. Built once at load, parallel to frames, when the
+    // owner asked for them (nullptr entries otherwise).
+    std::vector<SDL_Texture*> silhouettes;
 
     std::string on_end;
     bool randomize = false;
@@ -42,5 +59,22 @@ public:
     bool frozen = false;
 
 private:
-    // No private members required currently
+    struct MipLevel {
+        SDL_Surface* surface = nullptr;   // only kept when it could not be cached
+        SDL_Texture* texture = nullptr;
+        Uint32 last_used_ms = 0;
+        int file_index = 0;               // frame number in the cache folder
+        bool failed = false;              // cache file would not load
+    };
+
+    void build_mips(SDL_Surface* frame, int frame_index, bool from_cache);
+
+    // [frame][level - 1]; level 1 is half size. Levels live in the on-disk
+    // cache and are uploaded lazily from the const draw path, hence mutable.
+    mutable std::vector<std::vector<MipLevel>> mips_;
+    std::string cache_folder_;
+    SDL_Renderer* renderer_ = nullptr;
+    SDL_BlendMode blendmode_ = SDL_BLENDMODE_BLEND;
+    int frame_w_ = 0;
+    int frame_h_ = 0;
 };
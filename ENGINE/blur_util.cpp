@@ -1,9 +1,66 @@
 // === File: blur_util.cpp ===
 #include "blur_util.hpp"
+#include "pixel_kernels.hpp"
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
 #include <random>
+#include <thread>
+
+// Rows handed to each blur worker; below this a single thread wins.
+static constexpr int BLUR_ROWS_PER_WORKER = 64;
+
+// Number of nested boxes in the random-weight kernel.
+static constexpr int BLUR_RANDOM_BANDS = 4;
+
+template <typename Fn>
+static void run_blur_rows(int h, Fn&& fn) {
+    const int workers = std::clamp(h / BLUR_ROWS_PER_WORKER, 1,
+                                   std::max(1, int(std::thread::hardware_concurrency())));
+    if (workers == 1) {
+        fn(0, h);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    const int chunk = (h + workers - 1) / workers;
+    for (int i = 0; i < workers; ++i) {
+        const int y0 = i * chunk;
+        const int y1 = std::min(h, y0 + chunk);
+        if (y0 < y1) threads.emplace_back(fn, y0, y1);
+    }
+    for (auto& t : threads) t.join();
+}
+
+// Random-weight kernel, drawn once per call. Taps are grouped into bands by
+// distance from the centre; each band gets one weight from [lo, hi]. The
+// bands are expressed as nested boxes so the passes stay O(1) per pixel.
+static std::vector<PixelKernels::KernelStep> random_blur_kernel(int radius, float lo, float hi, std::mt19937& rng) {
+    const int bands = std::min(radius + 1, BLUR_RANDOM_BANDS);
+    std::uniform_real_distribution<float> dist(std::min(lo, hi), std::max(lo, hi));
+
+    std::vector<int> radii(bands);
+    std::vector<float> band_weight(bands);
+    for (int b = 0; b < bands; ++b) {
+        radii[b] = (b == bands - 1) ? radius : (radius * (b + 1)) / bands;
+        band_weight[b] = std::max(0.0f, dist(rng));
+    }
+
+    // Tap weight at |k| is band_weight of the innermost band reaching k, so
+    // each box carries the difference to the next band out.
+    float total = band_weight[0] * float(2 * radii[0] + 1);
+    for (int b = 1; b < bands; ++b) {
+        total += band_weight[b] * float(2 * (radii[b] - radii[b - 1]));
+    }
+    if (total <= 0.0f) return { { radius, Sint32((1 << 16) / (2 * radius + 1)) } };
+
+    std::vector<PixelKernels::KernelStep> steps(bands);
+    for (int b = 0; b < bands; ++b) {
+        const float next = (b + 1 < bands) ? band_weight[b + 1] : 0.0f;
+        steps[b] = { radii[b], Sint32(std::lround((band_weight[b] - next) / total * 65536.0f)) };
+    }
+    return steps;
+}
 
 BlurUtil::BlurUtil(SDL_Renderer* renderer,
                    int downscale,
@@ -14,15 +71,32 @@ BlurUtil::BlurUtil(SDL_Renderer* renderer,
       downscale_(downscale),
       blur_radius_(blur_radius),
       weight_min_(weight_min),
-      weight_max_(weight_max)
+      weight_max_(weight_max),
+      rng_(std::random_device{}())
 {}
 
+void BlurUtil::blur_pixels(std::vector<Uint8>& rgba, int w, int h, int radius, bool random_weights) {
+    if (radius <= 0 || w <= 0 || h <= 0) return;
+    std::vector<Uint8> temp(rgba.size());
+    Uint8* pixels = rgba.data();
+    Uint8* scratch = temp.data();
+
+    if (random_weights) {
+        const auto steps = random_blur_kernel(radius, weight_min_, weight_max_, rng_);
+        run_blur_rows(h, [&](int y0, int y1) { PixelKernels::stepped_blur_h(pixels, scratch, w, h, steps, y0, y1); });
+        run_blur_rows(h, [&](int y0, int y1) { PixelKernels::stepped_blur_v(scratch, pixels, w, h, steps, y0, y1); });
+    } else {
+        run_blur_rows(h, [&](int y0, int y1) { PixelKernels::box_blur_h(pixels, scratch, w, h, radius, y0, y1); });
+        run_blur_rows(h, [&](int y0, int y1) { PixelKernels::box_blur_v(scratch, pixels, w, h, radius, y0, y1); });
+    }
+}
+
 // Shared core function
 SDL_Texture* BlurUtil::blur_core(SDL_Texture* source_tex,
                                  int override_w,
                                  int override_h,
                                  int override_blur_radius,
-                                 std::function<float(std::mt19937&)> weight_func)
+                                 bool random_weights)
 {
     if (!source_tex) throw std::runtime_error("blur_core: source_tex is null");
 
@@ -44,11 +118,11 @@ SDL_Texture* BlurUtil::blur_core(SDL_Texture* source_tex,
     SDL_SetRenderTarget(renderer_, downscaled);
     SDL_RenderCopy(renderer_, source_tex, nullptr, nullptr);
 
-    // --- Step 2: Read pixels ---
-    SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, small_w, small_h, 32, SDL_PIXELFORMAT_RGBA8888);
+    // --- Step 2: Read pixels (byte order r, g, b, a, so unpacking is a copy) ---
+    SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, small_w, small_h, 32, SDL_PIXELFORMAT_RGBA32);
     if (!surf) throw std::runtime_error("blur_core: failed to create surface");
 
-    if (SDL_RenderReadPixels(renderer_, nullptr, SDL_PIXELFORMAT_RGBA8888,
+    if (SDL_RenderReadPixels(renderer_, nullptr, SDL_PIXELFORMAT_RGBA32,
                              surf->pixels, surf->pitch) != 0)
     {
         SDL_FreeSurface(surf);
@@ -56,63 +130,19 @@ SDL_Texture* BlurUtil::blur_core(SDL_Texture* source_tex,
         throw std::runtime_error("blur_core: SDL_RenderReadPixels failed");
     }
 
-    Uint32* pixels = static_cast<Uint32*>(surf->pixels);
-    std::vector<Uint32> temp(pixels, pixels + small_w * small_h);
-
-    std::mt19937 rng{ std::random_device{}() };
-
-    // --- Step 3: Horizontal pass ---
-    for (int y = 0; y < small_h; ++y) {
-        for (int x = 0; x < small_w; ++x) {
-            float r = 0, g = 0, b = 0, a = 0, total_weight = 0;
-
-            for (int k = -radius; k <= radius; ++k) {
-                int nx = std::clamp(x + k, 0, small_w - 1);
-                Uint8 pr, pg, pb, pa;
-                SDL_GetRGBA(temp[y * small_w + nx], surf->format, &pr, &pg, &pb, &pa);
-                float weight = weight_func(rng);
-                r += pr * weight; g += pg * weight; b += pb * weight; a += pa * weight;
-                total_weight += weight;
-            }
-
-            pixels[y * small_w + x] = SDL_MapRGBA(surf->format,
-                                                  static_cast<Uint8>(r / total_weight),
-                                                  static_cast<Uint8>(g / total_weight),
-                                                  static_cast<Uint8>(b / total_weight),
-                                                  static_cast<Uint8>(a / total_weight));
-        }
-    }
+    // --- Step 3: Blur ---
+    std::vector<Uint8> pixels;
+    PixelKernels::unpack_surface(surf, pixels);
+    blur_pixels(pixels, small_w, small_h, radius, random_weights);
+    PixelKernels::pack_surface(pixels, surf);
 
-    // --- Step 4: Vertical pass ---
-    temp.assign(pixels, pixels + small_w * small_h);
-    for (int y = 0; y < small_h; ++y) {
-        for (int x = 0; x < small_w; ++x) {
-            float r = 0, g = 0, b = 0, a = 0, total_weight = 0;
-
-            for (int k = -radius; k <= radius; ++k) {
-                int ny = std::clamp(y + k, 0, small_h - 1);
-                Uint8 pr, pg, pb, pa;
-                SDL_GetRGBA(temp[ny * small_w + x], surf->format, &pr, &pg, &pb, &pa);
-                float weight = weight_func(rng);
-                r += pr * weight; g += pg * weight; b += pb * weight; a += pa * weight;
-                total_weight += weight;
-            }
-
-            pixels[y * small_w + x] = SDL_MapRGBA(surf->format,
-                                                  static_cast<Uint8>(r / total_weight),
-                                                  static_cast<Uint8>(g / total_weight),
-                                                  static_cast<Uint8>(b / total_weight),
-                                                  static_cast<Uint8>(a / total_weight));
-        }
-    }
-
-    // --- Step 5: Create blurred small texture ---
+    // --- Step 4: Create blurred small texture ---
     SDL_Texture* blurred_small = SDL_CreateTextureFromSurface(renderer_, surf);
     SDL_SetTextureBlendMode(blurred_small, SDL_BLENDMODE_MOD);
     SDL_FreeSurface(surf);
     SDL_DestroyTexture(downscaled);
 
-    // --- Step 6: Scale back up ---
+    // --- Step 5: Scale back up ---
     SDL_Texture* blurred_full = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
                                                   SDL_TEXTUREACCESS_TARGET, w, h);
     SDL_SetTextureBlendMode(blurred_full, SDL_BLENDMODE_MOD);
@@ -124,14 +154,28 @@ SDL_Texture* BlurUtil::blur_core(SDL_Texture* source_tex,
     return blurred_full;
 }
 
+SDL_Surface* BlurUtil::blur_surface_core(SDL_Surface* src, int override_blur_radius, bool random_weights) {
+    if (!src) return nullptr;
+    const int radius = (override_blur_radius > 0) ? override_blur_radius : blur_radius_;
+
+    std::vector<Uint8> pixels;
+    if (!PixelKernels::unpack_surface(src, pixels)) return nullptr;
+
+    SDL_Surface* out = SDL_CreateRGBSurfaceWithFormat(0, src->w, src->h, 32, src->format->format);
+    if (!out) return nullptr;
+
+    blur_pixels(pixels, src->w, src->h, radius, random_weights);
+    PixelKernels::pack_surface(pixels, out);
+    return out;
+}
+
 // Public wrappers
 SDL_Texture* BlurUtil::blur_texture(SDL_Texture* source_tex,
                                     int override_w,
                                     int override_h,
                                     int override_blur_radius)
 {
-    return blur_core(source_tex, override_w, override_h, override_blur_radius,
-                     [](std::mt19937&) { return 1.0f; });
+    return blur_core(source_tex, override_w, override_h, override_blur_radius, false);
 }
 
 SDL_Texture* BlurUtil::blur_texture_random(SDL_Texture* source_tex,
@@ -139,9 +183,13 @@ SDL_Texture* BlurUtil::blur_texture_random(SDL_Texture* source_tex,
                                            int override_h,
                                            int override_blur_radius)
 {
-    return blur_core(source_tex, override_w, override_h, override_blur_radius,
-                     [this](std::mt19937& rng) {
-                         std::uniform_real_distribution<float> dist(weight_min_, weight_max_);
-                         return dist(rng);
-                     });
+    return blur_core(source_tex, override_w, override_h, override_blur_radius, true);
+}
+
+SDL_Surface* BlurUtil::blur_surface(SDL_Surface* src, int override_blur_radius) {
+    return blur_surface_core(src, override_blur_radius, false);
+}
+
+SDL_Surface* BlurUtil::blur_surface_random(SDL_Surface* src, int override_blur_radius) {
+    return blur_surface_core(src, override_blur_radius, true);
 }
@@ -1,8 +1,8 @@
 // === File: blur_util.hpp ===
 #pragma once
 #include <SDL.h>
-#include <functional>
 #include <random>
+#include <vector>
 
 class BlurUtil {
 public:
@@ -24,17 +24,28 @@ public:
                                      int override_h = 0,
                                      int override_blur_radius = 0);
 
+    // CPU-only variants for callers that already hold pixels: no downscale
+    // and no GPU round trip, the radius is in source pixels. Returns a new
+    // surface in src's format (caller frees) or nullptr on failure.
+    SDL_Surface* blur_surface(SDL_Surface* src, int override_blur_radius = 0);
+    SDL_Surface* blur_surface_random(SDL_Surface* src, int override_blur_radius = 0);
+
 private:
     SDL_Renderer* renderer_;
     int downscale_;
     int blur_radius_;
     float weight_min_;
     float weight_max_;
+    std::mt19937 rng_;
 
-    // Shared core blur function
     SDL_Texture* blur_core(SDL_Texture* source_tex,
                            int override_w,
                            int override_h,
                            int override_blur_radius,
-                           std::function<float(std::mt19937&)> weight_func);
+                           bool random_weights);
+
+    SDL_Surface* blur_surface_core(SDL_Surface* src, int override_blur_radius, bool random_weights);
+
+    // Separable blur of canonical RGBA pixels in place, split across threads.
+    void blur_pixels(std::vector<Uint8>& rgba, int w, int h, int radius, bool random_weights);
 };
@@ -0,0 +1,185 @@
+// === File: cast_shadow_pass.cpp ===
+#include "cast_shadow_pass.hpp"
+#include "Asset.hpp"
+#include "asset_info.hpp"
+#include "global_light_source.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// Silhouettes are only used as soft ground shadows, so they are stored small.
+constexpr int SHADOW_ATLAS_SIZE = 2048;
+constexpr int SHADOW_ATLAS_CELL = 128;
+// Shadow length as a fraction of the caster's on-screen height.
+constexpr float SHADOW_LENGTH = 0.6f;
+// Angle between the shadows of one caster when it has several.
+constexpr float SHADOW_SPREAD_RAD = 0.12f;
+// Sun elevation (sin of the orbit angle) at which shadows reach full strength.
+constexpr float SHADOW_FULL_ELEVATION = 0.25f;
+// Once full, the atlas starts over with the silhouettes in view, at most this often.
+constexpr int SHADOW_ATLAS_RESET_FRAMES = 120;
+
+// Keeps the darker of two shadows instead of stacking them. Renderers without
+// min/max blending fall back to plain alpha blending.
+bool set_shadow_blend(SDL_Texture* tex) {
+    static const SDL_BlendMode max_blend = SDL_ComposeCustomBlendMode(
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_MAXIMUM,
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_MAXIMUM);
+    if (SDL_SetTextureBlendMode(tex, max_blend) == 0) return true;
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    return false;
+}
+}
+
+CastShadowPass::CastShadowPass(SDL_Renderer* renderer, int screen_width, int screen_height)
+    : renderer_(renderer),
+      screen_width_(screen_width),
+      screen_height_(screen_height),
+      atlas_(renderer, SHADOW_ATLAS_SIZE, SHADOW_ATLAS_CELL)
+{}
+
+CastShadowPass::~CastShadowPass() {
+    if (buffer_) SDL_DestroyTexture(buffer_);
+}
+
+bool CastShadowPass::ensure_buffer() {
+    if (buffer_) return true;
+    buffer_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
+                                SDL_TEXTUREACCESS_TARGET, screen_width_, screen_height_);
+    if (!buffer_) {
+        std::cerr << "[CastShadowPass] Failed to create shadow buffer: " << SDL_GetError() << "\n";
+        return false;
+    }
+    SDL_SetTextureBlendMode(buffer_, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+bool CastShadowPass::begin(const Global_Light_Source& light) {
+    batch_vertices_.clear();
+    batch_indices_.clear();
+    unbatched_vertices_.clear();
+    unbatched_.clear();
+    built_ = false;
+
+    if (++frames_since_atlas_reset_ >= SHADOW_ATLAS_RESET_FRAMES && atlas_.is_full()) {
+        atlas_.reset();
+        frames_since_atlas_reset_ = 0;
+    }
+
+    // The sun sits at (cos, -sin) around the screen centre (sin > 0 is up),
+    // so shadows point the other way.
+    const float angle = light.get_angle();
+    const float elevation = std::sin(angle);
+    strength_ = std::clamp(elevation / SHADOW_FULL_ELEVATION, 0.0f, 1.0f);
+    dir_x_ = -std::cos(angle);
+    dir_y_ = elevation;
+    return strength_ > 0.0f;
+}
+
+void CastShadowPass::push_quad(std::vector<SDL_Vertex>& verts, const SDL_Rect& dst, float ox, float oy,
+                               float u0, float v0, float u1, float v1, SDL_Color color) const {
+    // Feet stay on the sprite's bottom edge; its top is laid out along (ox, oy).
+    const float x0 = static_cast<float>(dst.x);
+    const float x1 = static_cast<float>(dst.x + dst.w);
+    const float base_y = static_cast<float>(dst.y + dst.h);
+    verts.push_back({ { x0 + ox, base_y + oy }, color, { u0, v0 } });
+    verts.push_back({ { x1 + ox, base_y + oy }, color, { u1, v0 } });
+    verts.push_back({ { x1, base_y }, color, { u1, v1 } });
+    verts.push_back({ { x0, base_y }, color, { u0, v1 } });
+}
+
+void CastShadowPass::add(const Asset* a, const SDL_Rect& dst) {
+    if (strength_ <= 0.0f || !a || !a->info || !a->info->has_casted_shadows) return;
+    const int count = a->info->number_of_casted_shadows;
+    if (count <= 0 || a->info->cast_shadow_intensity <= 0 || dst.w <= 0 || dst.h <= 0) return;
+
+    SDL_Texture* silhouette = a->get_current_silhouette();
+    if (!silhouette) return;
+
+    // Strength is applied at composite; the buffer keeps each caster's intensity.
+    const float alpha = 255.0f * (a->info->cast_shadow_intensity / 100.0f);
+    const SDL_Color color{ 0, 0, 0, static_cast<Uint8>(std::clamp(alpha, 0.0f, 255.0f)) };
+    const float length = dst.h * SHADOW_LENGTH;
+
+    float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+    const SDL_Rect* region = atlas_.find_or_add(silhouette);
+    if (region) {
+        const float inv_atlas = 1.0f / atlas_.get_size();
+        u0 = (region->x + 0.5f) * inv_atlas;
+        u1 = (region->x + region->w - 0.5f) * inv_atlas;
+        v0 = (region->y + 0.5f) * inv_atlas;
+        v1 = (region->y + region->h - 0.5f) * inv_atlas;
+    }
+    if (a->flipped) std::swap(u0, u1);
+
+    for (int i = 0; i < count; ++i) {
+        const float spread = (i - (count - 1) * 0.5f) * SHADOW_SPREAD_RAD;
+        const float cs = std::cos(spread), sn = std::sin(spread);
+        const float ox = (dir_x_ * cs - dir_y_ * sn) * length;
+        const float oy = (dir_x_ * sn + dir_y_ * cs) * length;
+
+        if (region) {
+            const int base = static_cast<int>(batch_vertices_.size());
+            push_quad(batch_vertices_, dst, ox, oy, u0, v0, u1, v1, color);
+            batch_indices_.insert(batch_indices_.end(),
+                                  { base, base + 1, base + 2, base, base + 2, base + 3 });
+        } else {
+            unbatched_.push_back({ silhouette, static_cast<int>(unbatched_vertices_.size()) });
+            push_quad(unbatched_vertices_, dst, ox, oy, u0, v0, u1, v1, color);
+        }
+    }
+}
+
+SDL_Rect CastShadowPass::bounds(const SDL_Rect& dst) {
+    const int reach = static_cast<int>(std::ceil(dst.h * SHADOW_LENGTH));
+    return SDL_Rect{ dst.x - reach, dst.y + dst.h - reach, dst.w + 2 * reach, 2 * reach };
+}
+
+void CastShadowPass::build() {
+    built_ = false;
+    if (batch_indices_.empty() && unbatched_.empty()) return;
+    if (!ensure_buffer()) return;
+
+    SDL_Texture* prev_target = SDL_GetRenderTarget(renderer_);
+    SDL_SetRenderTarget(renderer_, buffer_);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
+    SDL_RenderClear(renderer_);
+
+    if (!batch_indices_.empty()) {
+        set_shadow_blend(atlas_.get_texture());
+        SDL_RenderGeometry(renderer_, atlas_.get_texture(),
+                           batch_vertices_.data(), static_cast<int>(batch_vertices_.size()),
+                           batch_indices_.data(), static_cast<int>(batch_indices_.size()));
+    }
+
+    static const int quad_indices[6] = { 0, 1, 2, 0, 2, 3 };
+    for (const Unbatched& u : unbatched_) {
+        SDL_BlendMode prev_mode = SDL_BLENDMODE_NONE;
+        SDL_GetTextureBlendMode(u.tex, &prev_mode);
+        set_shadow_blend(u.tex);
+        SDL_RenderGeometry(renderer_, u.tex, &unbatched_vertices_[u.first_vertex], 4, quad_indices, 6);
+        SDL_SetTextureBlendMode(u.tex, prev_mode);
+    }
+
+    SDL_SetRenderTarget(renderer_, prev_target);
+    built_ = true;
+}
+
+void CastShadowPass::composite(const SDL_Rect* area) {
+    if (!built_) return;
+
+    // The world pass may run on a smaller target; quads were queued in its
+    // coordinates, so only that corner of the buffer is used, at 1:1.
+    SDL_Rect used{ 0, 0, screen_width_, screen_height_ };
+    if (SDL_Texture* target = SDL_GetRenderTarget(renderer_)) {
+        SDL_QueryTexture(target, nullptr, nullptr, &used.w, &used.h);
+    }
+    used.w = std::min(used.w, screen_width_);
+    used.h = std::min(used.h, screen_height_);
+    if (area && !SDL_IntersectRect(area, &used, &used)) return;
+
+    SDL_SetTextureAlphaMod(buffer_, static_cast<Uint8>(strength_ * 255.0f));
+    SDL_RenderCopy(renderer_, buffer_, &used, &used);
+}
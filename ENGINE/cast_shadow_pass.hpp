@@ -0,0 +1,70 @@
+// === File: cast_shadow_pass.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+#include "light_atlas.hpp"
+
+class Asset;
+class Global_Light_Source;
+
+// Projected ground shadows for assets with has_casted_shadows. Each caster's
+// silhouette is skewed away from the Global_Light_Source into a quad; all
+// quads go into one SDL_RenderGeometry batch (silhouettes packed in a
+// LightAtlas) on a shared screen-sized buffer, which is composited once
+// before the sprites are drawn. Quads are combined with MAX blending, so
+// overlapping shadows do not darken each other, and the sun's strength is
+// applied once at composite. Shadows fade out while the sun is below the
+// horizon.
+class CastShadowPass {
+public:
+    CastShadowPass(SDL_Renderer* renderer, int screen_width, int screen_height);
+    ~CastShadowPass();
+
+    CastShadowPass(const CastShadowPass&) = delete;
+    CastShadowPass& operator=(const CastShadowPass&) = delete;
+
+    // Starts a frame. Returns false when shadows are invisible (night), in
+    // which case add(), build() and composite() do nothing.
+    bool begin(const Global_Light_Source& light);
+
+    // Queues the shadows of a, drawn at rect dst of the current target.
+    void add(const Asset* a, const SDL_Rect& dst);
+
+    // Draws the batch into the buffer.
+    void build();
+    // Composites the buffer onto the current target, only within area (in
+    // target pixels) if given. Can be called once per region after build().
+    void composite(const SDL_Rect* area = nullptr);
+
+    // Screen area the shadows of a caster drawn at dst can cover.
+    static SDL_Rect bounds(const SDL_Rect& dst);
+
+private:
+    struct Unbatched {
+        SDL_Texture* tex;
+        int first_vertex;
+    };
+
+    bool ensure_buffer();
+    void push_quad(std::vector<SDL_Vertex>& verts, const SDL_Rect& dst, float ox, float oy,
+                   float u0, float v0, float u1, float v1, SDL_Color color) const;
+
+    SDL_Renderer* renderer_;
+    int screen_width_;
+    int screen_height_;
+    SDL_Texture* buffer_ = nullptr;
+    LightAtlas atlas_;
+
+    float dir_x_ = 0.0f;
+    float dir_y_ = 0.0f;
+    float strength_ = 0.0f;
+    bool built_ = false;
+    int frames_since_atlas_reset_ = 0;
+
+    std::vector<SDL_Vertex> batch_vertices_;
+    std::vector<int> batch_indices_;
+    // Silhouettes that did not fit in the atlas, drawn one call each.
+    std::vector<SDL_Vertex> unbatched_vertices_;
+    std::vector<Unbatched> unbatched_;
+};
@@ -0,0 +1,74 @@
+// === File: dirty_tracker.cpp ===
+#include "dirty_tracker.hpp"
+#include "hash_utils.hpp"
+
+namespace {
+// Past this share of the screen, a full redraw is cheaper than clipping.
+constexpr float DIRTY_FULL_RATIO = 0.6f;
+// More rects than this are merged into their bounding box.
+constexpr size_t DIRTY_MAX_RECTS = 32;
+}
+
+DirtyTracker::DirtyTracker(int screen_width, int screen_height)
+    : screen_width_(screen_width), screen_height_(screen_height) {}
+
+void DirtyTracker::begin_frame() {
+    current_.clear();
+    dirty_.clear();
+}
+
+void DirtyTracker::record(std::uint64_t key, std::uint64_t look, const SDL_Rect& rect) {
+    // Identical things drawn twice in one frame get successive keys, which
+    // stay stable as long as the draw order does.
+    while (!current_.emplace(key, Record{ look, rect }).second) key = HashUtils::mix(key);
+}
+
+void DirtyTracker::add_dirty(const SDL_Rect& r) {
+    const SDL_Rect screen{ 0, 0, screen_width_, screen_height_ };
+    SDL_Rect clipped;
+    if (!SDL_IntersectRect(&r, &screen, &clipped)) return;
+
+    // Keep the list disjoint: swallow every rect the new one touches.
+    for (size_t i = 0; i < dirty_.size();) {
+        if (SDL_HasIntersection(&dirty_[i], &clipped)) {
+            SDL_UnionRect(&dirty_[i], &clipped, &clipped);
+            dirty_[i] = dirty_.back();
+            dirty_.pop_back();
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+    dirty_.push_back(clipped);
+}
+
+bool DirtyTracker::end_frame() {
+    const bool had_previous = has_previous_;
+    if (had_previous) {
+        for (const auto& [key, cur] : current_) {
+            auto it = previous_.find(key);
+            if (it == previous_.end()) {
+                add_dirty(cur.rect);
+            } else if (it->second.look != cur.look ||
+                       !SDL_RectEquals(&it->second.rect, &cur.rect)) {
+                add_dirty(it->second.rect);
+                add_dirty(cur.rect);
+            }
+        }
+        for (const auto& [key, prev] : previous_) {
+            if (!current_.count(key)) add_dirty(prev.rect);
+        }
+    }
+    previous_.swap(current_);
+    has_previous_ = true;
+    if (!had_previous) return false;
+
+    if (dirty_.size() > DIRTY_MAX_RECTS) {
+        SDL_Rect all = dirty_.front();
+        for (const SDL_Rect& r : dirty_) SDL_UnionRect(&all, &r, &all);
+        dirty_.assign(1, all);
+    }
+    long long area = 0;
+    for (const SDL_Rect& r : dirty_) area += static_cast<long long>(r.w) * r.h;
+    return area <= static_cast<long long>(DIRTY_FULL_RATIO * screen_width_ * screen_height_);
+}
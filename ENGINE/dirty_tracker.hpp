@@ -0,0 +1,42 @@
+// === File: dirty_tracker.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Finds the screen regions that changed between two frames. Everything drawn
+// is recorded with a key identifying it across frames, a hash of how it
+// looks and the rect it covers; anything that appeared, disappeared, moved or
+// changed look dirties its old and new rects.
+class DirtyTracker {
+public:
+    DirtyTracker(int screen_width, int screen_height);
+
+    void begin_frame();
+    void record(std::uint64_t key, std::uint64_t look, const SDL_Rect& rect);
+    // Compares with the previous frame. Returns false when the frame has to
+    // be redrawn in full (no previous frame, or most of the screen changed).
+    bool end_frame();
+    // Forgets the previous frame, so the next end_frame() asks for a full redraw.
+    void reset() { has_previous_ = false; }
+
+    // Merged, non-overlapping dirty rects in screen coordinates.
+    const std::vector<SDL_Rect>& get_dirty() const { return dirty_; }
+
+private:
+    struct Record {
+        std::uint64_t look;
+        SDL_Rect rect;
+    };
+
+    void add_dirty(const SDL_Rect& r);
+
+    int screen_width_;
+    int screen_height_;
+    bool has_previous_ = false;
+    std::unordered_map<std::uint64_t, Record> previous_;
+    std::unordered_map<std::uint64_t, Record> current_;
+    std::vector<SDL_Rect> dirty_;
+};
@@ -0,0 +1,63 @@
+// === File: frame_time_controller.cpp ===
+#include "frame_time_controller.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+struct QualityLevel {
+    float render_scale;
+    int   light_downscale;
+};
+
+constexpr QualityLevel QUALITY_LEVELS[] = {
+    { 1.0f,   4 },
+    { 1.0f,   6 },
+    { 0.875f, 8 },
+    { 0.75f,  8 },
+    { 0.625f, 8 },
+    { 0.5f,   8 },
+};
+constexpr int QUALITY_LEVEL_COUNT = static_cast<int>(sizeof(QUALITY_LEVELS) / sizeof(QUALITY_LEVELS[0]));
+
+constexpr double FRAME_SMOOTHING   = 0.1;    // weight of the newest frame
+constexpr float  DEGRADE_RATIO     = 0.9f;   // of budget
+constexpr float  RECOVER_RATIO     = 0.6f;   // of budget
+constexpr int    DEGRADE_FRAMES    = 15;     // frames to settle after a change
+constexpr int    RECOVER_FRAMES    = 90;
+}
+
+FrameTimeController::FrameTimeController(float budget_ms)
+    : budget_ms_(budget_ms) {}
+
+void FrameTimeController::begin_frame() {
+    frame_start_ = SDL_GetPerformanceCounter();
+}
+
+void FrameTimeController::end_frame() {
+    if (frame_start_ == 0) return;
+    const double ms = double(SDL_GetPerformanceCounter() - frame_start_) * 1000.0 /
+                      double(SDL_GetPerformanceFrequency());
+    avg_ms_ = (avg_ms_ == 0.0) ? ms : avg_ms_ + (ms - avg_ms_) * FRAME_SMOOTHING;
+    ++frames_at_level_;
+
+    int next = level_;
+    if (avg_ms_ > budget_ms_ * DEGRADE_RATIO && frames_at_level_ >= DEGRADE_FRAMES) {
+        next = std::min(level_ + 1, QUALITY_LEVEL_COUNT - 1);
+    } else if (avg_ms_ < budget_ms_ * RECOVER_RATIO && frames_at_level_ >= RECOVER_FRAMES) {
+        next = std::max(level_ - 1, 0);
+    }
+    if (next != level_) {
+        level_ = next;
+        frames_at_level_ = 0;
+        std::cout << "[FrameTimeController] " << avg_ms_ << " ms/frame, render scale "
+                  << get_render_scale() << ", light downscale " << get_light_downscale() << "\n";
+    }
+}
+
+float FrameTimeController::get_render_scale() const {
+    return QUALITY_LEVELS[level_].render_scale;
+}
+
+int FrameTimeController::get_light_downscale() const {
+    return QUALITY_LEVELS[level_].light_downscale;
+}
@@ -0,0 +1,35 @@
+// === File: frame_time_controller.hpp ===
+#pragma once
+
+#include <SDL.h>
+
+// Trades sharpness for frame rate. Frame times are smoothed and mapped onto a
+// pressure level; each level lowers the light map resolution first (cheap to
+// lose, lights are soft) and then the world render scale. Levels go up as
+// soon as the budget is missed and come back down only after a longer run of
+// fast frames, so the scale does not oscillate.
+class FrameTimeController {
+public:
+    explicit FrameTimeController(float budget_ms = 1000.0f / 30.0f);
+
+    // Bracket everything the frame costs, including SDL_RenderPresent, which
+    // is where waiting on the GPU shows up.
+    void begin_frame();
+    void end_frame();
+
+    // Fraction of the window resolution the world pass is rendered at.
+    float get_render_scale() const;
+    // LightMap downscale factor (screen pixels per light map pixel).
+    int   get_light_downscale() const;
+
+    int    get_level() const { return level_; }
+    double get_avg_frame_ms() const { return avg_ms_; }
+    void   set_budget_ms(float budget_ms) { budget_ms_ = budget_ms; }
+
+private:
+    float  budget_ms_;
+    double avg_ms_ = 0.0;
+    Uint64 frame_start_ = 0;
+    int    level_ = 0;
+    int    frames_at_level_ = 0;
+};
@@ -2,6 +2,8 @@
 
 #include "generate_light.hpp"
 #include "cache_manager.hpp"
+#include "hash_utils.hpp"
+#include "pixel_kernels.hpp"
 
 #include <SDL.h>
 #include <SDL_image.h>
@@ -11,6 +13,10 @@
 #include <cmath>
 #include <algorithm>
 #include <random>
+#include <sstream>
+#include <iomanip>
+#include <unordered_map>
+#include <thread>
 #include <vector>
 #include <iostream>
 
@@ -21,24 +27,71 @@
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
+static constexpr int RADIAL_LUT_SIZE = 4096;   // samples over d^2 / r^2
+static constexpr int ANGLE_LUT_SIZE  = 1024;   // samples over [-pi, pi)
+static constexpr int ROWS_PER_WORKER = 64;
+
+// atan2 to within ~0.005 rad, far below one ANGLE_LUT_SIZE bucket.
+static inline float fast_atan2(float y, float x) {
+    const float ax = std::fabs(x), ay = std::fabs(y);
+    const float mx = std::max(ax, ay), mn = std::min(ax, ay);
+    if (mx == 0.0f) return 0.0f;
+    const float a = mn / mx;
+    const float s = a * a;
+    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+    if (ay > ax) r = 1.57079637f - r;
+    if (x < 0.0f) r = 3.14159274f - r;
+    if (y < 0.0f) r = -r;
+    return r;
+}
+
+// Generated light textures, shared by every LightSource with the same key.
+// Like the rest of the asset textures they live until shutdown.
+static std::unordered_map<std::uint64_t, SDL_Texture*>& shared_light_textures() {
+    static std::unordered_map<std::uint64_t, SDL_Texture*> textures;
+    return textures;
+}
+
 GenerateLight::GenerateLight(SDL_Renderer* renderer)
     : renderer_(renderer) {}
 
+std::uint64_t GenerateLight::light_key(const LightSource& light, int blur_passes) {
+    std::uint64_t h = HashUtils::SEED;
+    HashUtils::combine(h, static_cast<std::uint64_t>(light.radius));
+    HashUtils::combine(h, static_cast<std::uint64_t>(light.fall_off));
+    HashUtils::combine(h, static_cast<std::uint64_t>(light.intensity));
+    HashUtils::combine(h, static_cast<std::uint64_t>(light.flare));
+    HashUtils::combine(h, (std::uint64_t(light.color.r) << 16) |
+                          (std::uint64_t(light.color.g) << 8) |
+                           std::uint64_t(light.color.b));
+    HashUtils::combine(h, static_cast<std::uint64_t>(blur_passes));
+    HashUtils::combine(h, static_cast<std::uint64_t>(light.max_resolution));
+    return h;
+}
+
 SDL_Texture* GenerateLight::generate(SDL_Renderer* renderer,
-                                     const std::string& asset_name,
-                                     const LightSource& light,
-                                     std::size_t light_index)
+                                     const LightSource& light)
 {
     if (!renderer) return nullptr;
 
-    const std::string cache_root = "cache/" + asset_name + "/lights";
-    const std::string folder     = cache_root + "/" + std::to_string(light_index);
-    const std::string meta_file  = folder + "/metadata.json";
-    const std::string img_file   = folder + "/light.png";
-
     // Old look: no blur used. Keep this in metadata for cache key.
     const int blur_passes = 0;
 
+    const std::uint64_t key = light_key(light, blur_passes);
+    std::uint64_t texture_key = key;
+    HashUtils::combine_ptr(texture_key, renderer);
+
+    auto& shared = shared_light_textures();
+    auto found = shared.find(texture_key);
+    if (found != shared.end()) return found->second;
+
+    std::ostringstream key_hex;
+    key_hex << std::hex << std::setw(16) << std::setfill('0') << key;
+
+    const std::string folder     = "cache/lights/" + key_hex.str();
+    const std::string meta_file  = folder + "/metadata.json";
+    const std::string img_file   = folder + "/light.png";
+
     json meta;
     if (CacheManager::load_metadata(meta_file, meta)) {
         bool meta_ok =
@@ -47,6 +100,7 @@ SDL_Texture* GenerateLight::generate(SDL_Renderer* renderer,
             meta.value("intensity",-1) == light.intensity &&
             meta.value("flare",    -1) == light.flare && // kept for key stability, not used
             meta.value("blur_passes", -1) == blur_passes &&
+            meta.value("max_resolution", -1) == light.max_resolution &&
             meta.contains("color") &&
             meta["color"].is_array() && meta["color"].size() == 3 &&
             meta["color"][0].get<int>() == light.color.r &&
@@ -59,6 +113,8 @@ SDL_Texture* GenerateLight::generate(SDL_Renderer* renderer,
                 SDL_FreeSurface(surf);
                 if (tex) {
                     SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+                    SDL_SetTextureScaleMode(tex, SDL_ScaleModeLinear);
+                    shared[texture_key] = tex;
                     return tex;
                 }
             }
@@ -69,14 +125,17 @@ SDL_Texture* GenerateLight::generate(SDL_Renderer* renderer,
     fs::remove_all(folder);
     fs::create_directories(folder);
 
-    const int radius    = light.radius;
     const int falloff   = std::clamp(light.fall_off, 0, 100);
     const SDL_Color col = light.color;
     const int intensity = std::clamp(light.intensity, 0, 255);
     // flare kept in metadata for compatibility, but not used in old look
     const int flare     = std::clamp(light.flare, 0, 100);
 
-    const int size = std::max(1, radius * 2);
+    // Gradients are smooth, so the texture is generated at no more than
+    // max_resolution per side and stretched to 2 * radius with linear filtering.
+    const int logical_size = std::max(1, light.radius * 2);
+    const int size = std::max(1, std::min(logical_size, light.max_resolution > 0 ? light.max_resolution : logical_size));
+    const float radius = size * 0.5f;
 
     SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_RGBA32);
     if (!surf) {
@@ -90,15 +149,22 @@ SDL_Texture* GenerateLight::generate(SDL_Renderer* renderer,
         return nullptr;
     }
 
-    Uint32* pixels = static_cast<Uint32*>(surf->pixels);
-    SDL_PixelFormat* fmt = surf->format;
+    PixelKernels::Layout layout;
+    if (!PixelKernels::layout_of(surf->format, layout)) {
+        std::cerr << "[GenerateLight] Unsupported surface format\n";
+        SDL_UnlockSurface(surf);
+        SDL_FreeSurface(surf);
+        return nullptr;
+    }
 
     // White core from old version
-    float white_core_ratio  = std::pow(1.0f - falloff / 100.0f, 2.0f);
-    float white_core_radius = radius * white_core_ratio;
+    const float white_core_ratio  = std::pow(1.0f - falloff / 100.0f, 2.0f);
+    const float white_core_radius = radius * white_core_ratio;
+    const SDL_Color core{ Uint8((255 + col.r) / 2), Uint8((255 + col.g) / 2), Uint8((255 + col.b) / 2), 255 };
 
-    // Ultra-subtle, wide light rays from old version
-    std::mt19937 rng(std::random_device{}());
+    // Ultra-subtle, wide light rays from old version. Seeded from the key so a
+    // rebuilt cache entry looks the same as the one it replaces.
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(key ^ (key >> 32)));
     std::uniform_real_distribution<float> angle_dist(0.0f, 2.0f * float(M_PI));
     std::uniform_real_distribution<float> spread_dist(0.2f, 0.6f);   // wide spread
     std::uniform_int_distribution<int>    ray_count_dist(4, 7);
@@ -110,68 +176,92 @@ SDL_Texture* GenerateLight::generate(SDL_Renderer* renderer,
         rays.emplace_back(angle_dist(rng), spread_dist(rng));
     }
 
-    // Fill with transparent outside radius
-    auto put_pixel = [&](int x, int y, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
-        pixels[y * size + x] = SDL_MapRGBA(fmt, r, g, b, a);
-    };
-
-    for (int y = 0; y < size; ++y) {
-        for (int x = 0; x < size; ++x) {
-            float dx = x - radius + 0.5f;
-            float dy = y - radius + 0.5f;
-            float dist = std::sqrt(dx * dx + dy * dy);
+    // Ray boost up to 10% along wide angular bands, tabulated over [-pi, pi).
+    std::vector<float> ray_lut(ANGLE_LUT_SIZE);
+    for (int i = 0; i < ANGLE_LUT_SIZE; ++i) {
+        const float angle = (i + 0.5f) * (2.0f * float(M_PI) / ANGLE_LUT_SIZE) - float(M_PI);
+        float ray_boost = 1.0f;
+        for (const auto& rs : rays) {
+            float diff = std::fabs(angle - rs.first);
+            diff = std::fmod(diff + 2.0f * float(M_PI), 2.0f * float(M_PI));
+            if (diff > float(M_PI)) diff = 2.0f * float(M_PI) - diff;
+            if (diff < rs.second) ray_boost += (1.0f - diff / rs.second) * 0.05f; // extremely subtle
+        }
+        ray_lut[i] = std::clamp(ray_boost, 1.0f, 1.1f);
+    }
 
-            if (dist > radius) {
-                put_pixel(x, y, 0, 0, 0, 0);
-                continue;
-            }
+    // Radial profile tabulated over d^2 / r^2, so no sqrt or pow per pixel:
+    // old power-law alpha falloff plus the core-to-edge color ramp.
+    struct RadialSample { float alpha; Uint8 r, g, b; };
+    std::vector<RadialSample> radial_lut(RADIAL_LUT_SIZE + 1);
+    for (int i = 0; i <= RADIAL_LUT_SIZE; ++i) {
+        const float dist = std::sqrt(float(i) / RADIAL_LUT_SIZE) * radius;
+        RadialSample& rs = radial_lut[i];
+        rs.alpha = std::pow(1.0f - dist / radius, 1.4f);
+        if (dist <= white_core_radius) {
+            rs.r = core.r; rs.g = core.g; rs.b = core.b;
+        } else {
+            const float t = (dist - white_core_radius) / std::max(1e-6f, (radius - white_core_radius));
+            rs.r = static_cast<Uint8>((1.0f - t) * core.r + t * col.r);
+            rs.g = static_cast<Uint8>((1.0f - t) * core.g + t * col.g);
+            rs.b = static_cast<Uint8>((1.0f - t) * core.b + t * col.b);
+        }
+    }
 
-            float angle = std::atan2(dy, dx);
-
-            // Ray boost up to 10% along wide angular bands
-            float ray_boost = 1.0f;
-            for (const auto& rs : rays) {
-                float ray_angle = rs.first;
-                float spread    = rs.second;
-                float diff = std::fabs(angle - ray_angle);
-                diff = std::fmod(diff + 2.0f * float(M_PI), 2.0f * float(M_PI));
-                if (diff > float(M_PI)) diff = 2.0f * float(M_PI) - diff;
-                if (diff < spread) {
-                    float f = 1.0f - (diff / spread);
-                    ray_boost += f * 0.05f; // extremely subtle
+    const float r2 = radius * radius;
+    const float d2_to_index = RADIAL_LUT_SIZE / r2;
+    const float angle_to_index = ANGLE_LUT_SIZE / (2.0f * float(M_PI));
+    // Old scaling used 1.6
+    const float alpha_scale = intensity * 1.6f;
+
+    // RGBA32 rows are written in place; other layouts go through pack_row.
+    const bool direct = PixelKernels::is_canonical(layout);
+    auto fill_rows = [&](int y0, int y1) {
+        std::vector<Uint8> line(direct ? 0 : size_t(size) * 4);
+        for (int y = y0; y < y1; ++y) {
+            Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surf->pixels) + y * surf->pitch);
+            Uint8* out = direct ? reinterpret_cast<Uint8*>(row) : line.data();
+            const float dy = y - radius + 0.5f;
+            for (int x = 0; x < size; ++x) {
+                Uint8* px = out + size_t(x) * 4;
+                const float dx = x - radius + 0.5f;
+                const float d2 = dx * dx + dy * dy;
+                if (d2 > r2) {
+                    px[0] = px[1] = px[2] = px[3] = 0;
+                    continue;
                 }
+
+                const RadialSample& rs = radial_lut[std::min(RADIAL_LUT_SIZE, int(d2 * d2_to_index))];
+                const int ai = int((fast_atan2(dy, dx) + float(M_PI)) * angle_to_index);
+                const float boost = ray_lut[std::clamp(ai, 0, ANGLE_LUT_SIZE - 1)];
+
+                const float alpha_ratio = std::min(1.0f, rs.alpha * boost);
+                const Uint32 alpha = static_cast<Uint32>(std::min(255.0f, alpha_scale * alpha_ratio));
+
+                px[0] = rs.r;
+                px[1] = rs.g;
+                px[2] = rs.b;
+                px[3] = Uint8(alpha);
             }
-            ray_boost = std::clamp(ray_boost, 1.0f, 1.1f);
-
-            // Old power-law alpha falloff
-            float alpha_ratio = std::pow(1.0f - (dist / float(radius)), 1.4f);
-            alpha_ratio = std::clamp(alpha_ratio * ray_boost, 0.0f, 1.0f);
-
-            // Old scaling used 1.6
-            Uint8 alpha = static_cast<Uint8>(std::min(255.0f, intensity * alpha_ratio * 1.6f));
-
-            SDL_Color final_color;
-            if (dist <= white_core_radius) {
-                // Blend toward white in the core
-                final_color.r = static_cast<Uint8>((255 + col.r) / 2);
-                final_color.g = static_cast<Uint8>((255 + col.g) / 2);
-                final_color.b = static_cast<Uint8>((255 + col.b) / 2);
-                final_color.a = alpha;
-            } else {
-                // Interpolate from whitish core color to base color
-                float t = (dist - white_core_radius) / std::max(1e-6f, (radius - white_core_radius));
-                Uint8 core_r = static_cast<Uint8>((255 + col.r) / 2);
-                Uint8 core_g = static_cast<Uint8>((255 + col.g) / 2);
-                Uint8 core_b = static_cast<Uint8>((255 + col.b) / 2);
-
-                final_color.r = static_cast<Uint8>((1.0f - t) * core_r + t * col.r);
-                final_color.g = static_cast<Uint8>((1.0f - t) * core_g + t * col.g);
-                final_color.b = static_cast<Uint8>((1.0f - t) * core_b + t * col.b);
-                final_color.a = alpha;
-            }
+            if (!direct) PixelKernels::pack_row(line.data(), row, size, layout);
+        }
+    };
 
-            put_pixel(x, y, final_color.r, final_color.g, final_color.b, final_color.a);
+    // Split rows across threads; small lights are not worth the spawn.
+    const int workers = std::clamp(size / ROWS_PER_WORKER, 1,
+                                   std::max(1, int(std::thread::hardware_concurrency())));
+    if (workers == 1) {
+        fill_rows(0, size);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        const int chunk = (size + workers - 1) / workers;
+        for (int w = 0; w < workers; ++w) {
+            const int y0 = w * chunk;
+            const int y1 = std::min(size, y0 + chunk);
+            if (y0 < y1) threads.emplace_back(fill_rows, y0, y1);
         }
+        for (auto& t : threads) t.join();
     }
 
     SDL_UnlockSurface(surf);
@@ -183,6 +273,7 @@ SDL_Texture* GenerateLight::generate(SDL_Renderer* renderer,
         return nullptr;
     }
     SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(tex, SDL_ScaleModeLinear);
 
     // Cache result
     CacheManager::save_surface_as_png(surf, img_file);
@@ -194,8 +285,10 @@ SDL_Texture* GenerateLight::generate(SDL_Renderer* renderer,
     new_meta["intensity"]   = light.intensity;
     new_meta["flare"]       = flare;        // stored, not used
     new_meta["blur_passes"] = blur_passes;  // 0 for old look
+    new_meta["max_resolution"] = light.max_resolution;
     new_meta["color"]       = { col.r, col.g, col.b };
     CacheManager::save_metadata(meta_file, new_meta);
 
+    shared[texture_key] = tex;
     return tex;
 }
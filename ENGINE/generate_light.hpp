@@ -4,16 +4,21 @@
 #include <SDL.h>
 #include <string>
 #include <cstddef>
+#include <cstdint>
 #include "light_source.hpp"
 
 class GenerateLight {
 public:
     GenerateLight(SDL_Renderer* renderer);
 
+    // Textures are content-addressed: lights with the same generation
+    // parameters share one texture (and one cache/lights/<key> entry).
+    // The returned texture is owned by GenerateLight; do not destroy it.
     SDL_Texture* generate(SDL_Renderer* renderer,
-                          const std::string& asset_name,
-                          const LightSource& light,
-                          std::size_t light_index);
+                          const LightSource& light);
+
+    // Hash of everything that affects the generated pixels.
+    static std::uint64_t light_key(const LightSource& light, int blur_passes);
 
 private:
     SDL_Renderer* renderer_;
@@ -11,6 +11,12 @@
 
 using json = nlohmann::json;
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static constexpr int DEFAULT_LIGHTING_STATES = 24;
+
 Global_Light_Source::Global_Light_Source(SDL_Renderer* renderer,
                                        int screen_center_x,
                                        int screen_center_y,
@@ -36,6 +42,7 @@ Global_Light_Source::Global_Light_Source(SDL_Renderer* renderer,
     intensity_       = 255.0f;
     mult_            = 0.4f;
     fall_off_        = 1.0f;
+    max_resolution_  = 512;
     orbit_radius     = screen_width / 4;
     update_interval_ = 2;
 
@@ -58,6 +65,7 @@ Global_Light_Source::Global_Light_Source(SDL_Renderer* renderer,
     update_interval_ = j["update_interval"].get<int>();
     mult_            = j["mult"].get<float>();
     fall_off_        = j["fall_off"].get<float>();
+    max_resolution_  = j.value("max_resolution", 512);
 
     // base_color
     auto& bc = j["base_color"];
@@ -84,10 +92,17 @@ Global_Light_Source::Global_Light_Source(SDL_Renderer* renderer,
         key_colors_.push_back({deg,c});
     }
 
+    build_color_lut();
+    build_states(j.value("lighting_states", DEFAULT_LIGHTING_STATES));
+
     build_texture();
 }
 
 void Global_Light_Source::update() {
+    if (crossfade_ < 1.0f) {
+        crossfade_ = std::min(1.0f, crossfade_ + 1.0f / STATE_CROSSFADE_FRAMES);
+    }
+
     // only run every N frames
     if (++frame_counter_ % update_interval_ != 0) {
         //std::cout << "[MapLight::update] skipping frame " << frame_counter_ << "\n";
@@ -118,21 +133,15 @@ void Global_Light_Source::update() {
     //std::cout << "[MapLight::update] pos_x=" << pos_x_ << " pos_y=" << pos_y_
       //        << " (cos=" << ca << " sin=" << sa << ")\n";
 
-    // interpolate color solely from keys
-    SDL_Color k = compute_color_from_horizon();
-    current_color_ = k;
-
-
-    // update tint
-    tint_.r = Uint8(std::clamp(int(current_color_.r * mult_), 0, 255));
-    tint_.g = Uint8(std::clamp(int(current_color_.g * mult_), 0, 255));
-    tint_.b = Uint8(std::clamp(int(current_color_.b * mult_), 0, 255));
-    tint_.a = 255;
-    //std::cout << "[MapLight::update] tint=(r" << int(tint_.r)
-    //          << " g" << int(tint_.g) << " b" << int(tint_.b) << ")\n";
-
-    set_light_brightness();
-    //std::cout << "[MapLight::update] light_brightness=" << light_brightness << "\n";
+    // step to the lighting state for this angle; colors between steps are not used
+    const int count = static_cast<int>(states_.size());
+    const int idx = std::min(count - 1, static_cast<int>(horizon_degree() * count / 360.0f));
+    if (idx != state_index_) {
+        const bool first = (state_index_ < 0);
+        prev_state_index_ = first ? idx : state_index_;
+        crossfade_ = first ? 1.0f : 0.0f;
+        apply_state(idx);
+    }
 }
 
 std::pair<int,int> Global_Light_Source::get_position() const {
@@ -151,21 +160,53 @@ SDL_Color Global_Light_Source::get_tint() const {
     return tint_;
 }
 
-void Global_Light_Source::set_light_brightness() {
+int Global_Light_Source::brightness_for_alpha(int a) {
     constexpr int OFF = 245, FULL = 100;
-    int a = current_color_.a;
-    if (a >= OFF) {
-        light_brightness = 0;
-    } else if (a <= FULL) {
-        light_brightness = 255;
-    } else {
-        float r = float(OFF - a) / float(OFF - FULL);
-        light_brightness = int(r * 255.0f);
+    if (a >= OFF) return 0;
+    if (a <= FULL) return 255;
+    float r = float(OFF - a) / float(OFF - FULL);
+    return int(r * 255.0f);
+}
+
+SDL_Color Global_Light_Source::tint_for_color(const SDL_Color& c) const {
+    return {
+        Uint8(std::clamp(int(c.r * mult_), 0, 255)),
+        Uint8(std::clamp(int(c.g * mult_), 0, 255)),
+        Uint8(std::clamp(int(c.b * mult_), 0, 255)),
+        255
+    };
+}
+
+void Global_Light_Source::build_color_lut() {
+    for (int d = 0; d < 360; ++d) {
+        color_lut_[d] = color_at_degree(static_cast<float>(d));
+    }
+}
+
+// Each state samples the curve at the middle of its arc.
+void Global_Light_Source::build_states(int count) {
+    count = std::clamp(count, 1, 360);
+    states_.clear();
+    states_.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const int deg = static_cast<int>((i + 0.5f) * 360.0f / count) % 360;
+        const SDL_Color c = color_lut_[deg];
+        states_.push_back({ c, tint_for_color(c), brightness_for_alpha(c.a) });
     }
+    std::cout << "[MapLight] " << count << " lighting states\n";
+}
+
+void Global_Light_Source::apply_state(int index) {
+    state_index_     = index;
+    const LightingState& st = states_[index];
+    current_color_   = st.color;
+    tint_            = st.tint;
+    light_brightness = st.brightness;
 }
 
 void Global_Light_Source::build_texture() {
-    if (texture_) SDL_DestroyTexture(texture_);
+    // Owned by GenerateLight's shared light table.
+    texture_ = nullptr;
 
     LightSource ls;
     ls.radius    = int(radius_);
@@ -173,24 +214,29 @@ void Global_Light_Source::build_texture() {
     ls.fall_off  = int(fall_off_);
     ls.flare     = 0;
     ls.color     = base_color_;
+    ls.max_resolution = max_resolution_;
 
     GenerateLight gen(renderer_);
-    texture_ = gen.generate(renderer_, "map", ls, 0);
+    texture_ = gen.generate(renderer_, ls);
     if (!texture_) {
         std::cerr << "[MapLight] build_texture failed\n";
         cached_w_ = cached_h_ = 0;
     } else {
-        SDL_QueryTexture(texture_, nullptr, nullptr, &cached_w_, &cached_h_);
+        // logical size; the texture is generated at max_resolution_ at most
+        cached_w_ = cached_h_ = std::max(1, ls.radius * 2);
     }
 }
 
 
 
-SDL_Color Global_Light_Source::compute_color_from_horizon() const {
+float Global_Light_Source::horizon_degree() const {
     // rotate so sin=1 (up) lines up with 0°
     float deg = std::fmod(angle_ * (180.0f/float(M_PI)) + 270.0f, 360.0f);
     if (deg < 0) deg += 360.0f;
+    return deg;
+}
 
+SDL_Color Global_Light_Source::color_at_degree(float deg) const {
     auto lerp = [](Uint8 A, Uint8 B, float t){
         return Uint8(A + (B - A) * t);
     };
@@ -227,15 +273,20 @@ SDL_Color Global_Light_Source::compute_color_from_horizon() const {
 }
 
 SDL_Color Global_Light_Source::apply_tint_to_color(const SDL_Color& base, int alpha_mod) const {
+    return apply_tint_to_color(base, alpha_mod, tint_);
+}
+
+SDL_Color Global_Light_Source::apply_tint_to_color(const SDL_Color& base, int alpha_mod,
+                                                   const SDL_Color& tint) const {
     float factor = mult_ * (alpha_mod / 255.0f);
     auto blend = [&](Uint8 bc, Uint8 tc){
         float val = bc * (1.0f - mult_) + tc * factor;
         return Uint8(std::clamp(val, 0.0f, 255.0f));
     };
     return {
-        blend(base.r, tint_.r),
-        blend(base.g, tint_.g),
-        blend(base.b, tint_.b),
+        blend(base.r, tint.r),
+        blend(base.g, tint.g),
+        blend(base.b, tint.b),
         base.a
     };
 }
@@ -248,9 +299,40 @@ int Global_Light_Source::get_brightness() const {
     return light_brightness;
 }
 
+static SDL_Color lerp_color(const SDL_Color& a, const SDL_Color& b, float t) {
+    auto l = [t](Uint8 x, Uint8 y) { return Uint8(x + (int(y) - int(x)) * t); };
+    return { l(a.r, b.r), l(a.g, b.g), l(a.b, b.b), l(a.a, b.a) };
+}
+
+SDL_Color Global_Light_Source::get_blended_color() const {
+    if (prev_state_index_ < 0 || crossfade_ >= 1.0f) return current_color_;
+    return lerp_color(states_[prev_state_index_].color, current_color_, crossfade_);
+}
+
+SDL_Color Global_Light_Source::get_blended_tint() const {
+    if (prev_state_index_ < 0 || crossfade_ >= 1.0f) return tint_;
+    return lerp_color(states_[prev_state_index_].tint, tint_, crossfade_);
+}
+
+int Global_Light_Source::get_blended_brightness() const {
+    if (prev_state_index_ < 0 || crossfade_ >= 1.0f) return light_brightness;
+    const int from = states_[prev_state_index_].brightness;
+    return from + static_cast<int>((light_brightness - from) * crossfade_);
+}
+
+SDL_Color Global_Light_Source::apply_blended_tint_to_color(const SDL_Color& base, int alpha_mod) const {
+    return apply_tint_to_color(base, alpha_mod, get_blended_tint());
+}
+
+int Global_Light_Source::get_next_state_index() const {
+    if (state_index_ < 0) return -1;
+    // update() decreases the angle, which walks the horizon degree (and the
+    // state index) downwards.
+    const int count = static_cast<int>(states_.size());
+    return (state_index_ + count - 1) % count;
+}
+
 Global_Light_Source::~Global_Light_Source() {
-    if (texture_) {
-        SDL_DestroyTexture(texture_);
-        texture_ = nullptr;
-    }
+    // texture_ is shared through GenerateLight and not destroyed here.
+    texture_ = nullptr;
 }
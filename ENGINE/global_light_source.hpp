@@ -2,12 +2,22 @@
 #pragma once
 
 #include <SDL.h>
+#include <array>
 #include <vector>
 #include <utility>
 #include <string>
 
 class Global_Light_Source {
 public:
+    struct LightingState {
+        SDL_Color color;
+        SDL_Color tint;
+        int brightness;
+    };
+
+    // Frames a lighting-state step takes to crossfade in.
+    static constexpr int STATE_CROSSFADE_FRAMES = 45;
+
     Global_Light_Source(SDL_Renderer* renderer,
                         int screen_center_x,
                         int screen_center_y,
@@ -26,10 +36,31 @@ public:
 
     // Optional helper: apply current tint to a color with external alpha modifier
     SDL_Color apply_tint_to_color(const SDL_Color& base, int alpha_mod) const;
+    // Same blend with an explicit tint (e.g. one of the lighting states).
+    SDL_Color apply_tint_to_color(const SDL_Color& base, int alpha_mod, const SDL_Color& tint) const;
 
     SDL_Color get_current_color() const;
     int       get_brightness() const;
 
+    // The day/night cycle is quantized into K lighting states ("lighting_states"
+    // in map_light.json). The getters above return the current state, which is
+    // what final textures are baked from; bakes only change when it steps.
+    int   get_state_index() const { return state_index_; }
+    int   get_previous_state_index() const { return prev_state_index_; }
+    int   get_state_count() const { return static_cast<int>(states_.size()); }
+    // State the sun moves into next (-1 before the first update).
+    int   get_next_state_index() const;
+    const LightingState& get_lighting_state(int index) const { return states_[index]; }
+    // 0 right after a step, 1 once the crossfade from the previous state is done.
+    float get_crossfade() const { return crossfade_; }
+
+    // Previous state blended into the current one by get_crossfade(), for
+    // passes drawn every frame without a bake (uniform sprites, light map).
+    SDL_Color get_blended_color() const;
+    SDL_Color get_blended_tint() const;
+    int       get_blended_brightness() const;
+    SDL_Color apply_blended_tint_to_color(const SDL_Color& base, int alpha_mod) const;
+
     // Cached dimensions for performance
     int get_cached_w() const { return cached_w_; }
     int get_cached_h() const { return cached_h_; }
@@ -41,8 +72,13 @@ private:
     };
 
     void build_texture();
-    void set_light_brightness();
-    SDL_Color compute_color_from_horizon() const;
+    void build_color_lut();
+    void build_states(int count);
+    void apply_state(int index);
+    float horizon_degree() const;
+    SDL_Color color_at_degree(float deg) const;
+    SDL_Color tint_for_color(const SDL_Color& c) const;
+    static int brightness_for_alpha(int a);
 
 private:
     SDL_Renderer* renderer_;
@@ -68,11 +104,20 @@ private:
     float intensity_;
     float mult_;
     float fall_off_;
+    int   max_resolution_;
     int   orbit_radius;
     int   update_interval_;
 
     std::vector<KeyEntry> key_colors_;
 
+    // Key curve sampled once per degree of horizon angle.
+    std::array<SDL_Color, 360> color_lut_{};
+
+    std::vector<LightingState> states_;
+    int   state_index_      = -1;   // -1 until the first angle is picked
+    int   prev_state_index_ = -1;
+    float crossfade_        = 1.0f;
+
     // Cached texture dimensions
     int cached_w_ = 0;
     int cached_h_ = 0;
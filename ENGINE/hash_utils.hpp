@@ -0,0 +1,26 @@
+// hash_utils.hpp
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace HashUtils {
+
+constexpr std::uint64_t SEED = 1469598103934665603ull;
+
+// 64-bit mix (splitmix64 finalizer) so neighbouring inputs land far apart.
+inline std::uint64_t mix(std::uint64_t v) {
+    v ^= v >> 30; v *= 0xbf58476d1ce4e5b9ull;
+    v ^= v >> 27; v *= 0x94d049bb133111ebull;
+    v ^= v >> 31;
+    return v;
+}
+
+inline void combine(std::uint64_t& seed, std::uint64_t v) {
+    seed ^= mix(v) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+inline void combine_ptr(std::uint64_t& seed, const void* p) {
+    combine(seed, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(p)));
+}
+
+} // namespace HashUtils
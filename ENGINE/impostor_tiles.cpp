@@ -0,0 +1,206 @@
+// === File: impostor_tiles.cpp ===
+#include "impostor_tiles.hpp"
+#include "render_utils.hpp"
+#include "render_asset.hpp"
+#include "hash_utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+// Texels per world pixel at gameplay zoom, and the most halvings of it used
+// for farther views.
+constexpr float IMPOSTOR_LEAF_DENSITY = 1.0f;
+constexpr int   IMPOSTOR_DENSITY_LEVELS = 3;
+// Largest texture side of any leaf; density drops further to fit.
+constexpr int IMPOSTOR_MAX_TEXTURE = 4096;
+// Leaves baked for an older look or density re-baked per frame; the rest
+// keep drawing their old texture meanwhile.
+constexpr int IMPOSTOR_REBAKES_PER_FRAME = 4;
+
+SDL_Rect rect_union(const SDL_Rect& a, const SDL_Rect& b) {
+    if (a.w <= 0 || a.h <= 0) return b;
+    if (b.w <= 0 || b.h <= 0) return a;
+    const int x0 = std::min(a.x, b.x);
+    const int y0 = std::min(a.y, b.y);
+    const int x1 = std::max(a.x + a.w, b.x + b.w);
+    const int y1 = std::max(a.y + a.h, b.y + b.h);
+    return SDL_Rect{ x0, y0, x1 - x0, y1 - y0 };
+}
+
+void size_texture(int bw, int bh, int density_level, int& tex_w, int& tex_h) {
+    const float density = std::min(IMPOSTOR_LEAF_DENSITY / float(1 << density_level),
+                                   float(IMPOSTOR_MAX_TEXTURE) / float(std::max(1, std::max(bw, bh))));
+    tex_w = std::max(1, static_cast<int>(bw * density));
+    tex_h = std::max(1, static_cast<int>(bh * density));
+}
+
+// Coarsest level that still has a texel per window pixel at inv_scale.
+int density_level_for(float inv_scale) {
+    int level = 0;
+    while (level + 1 < IMPOSTOR_DENSITY_LEVELS &&
+           IMPOSTOR_LEAF_DENSITY / float(2 << level) >= inv_scale) {
+        ++level;
+    }
+    return level;
+}
+}
+
+ImpostorTiles::ImpostorTiles(SDL_Renderer* renderer, RenderUtils& util, RenderAsset& render_asset,
+                             int screen_width, int screen_height)
+    : renderer_(renderer),
+      util_(util),
+      render_asset_(render_asset),
+      screen_width_(screen_width),
+      screen_height_(screen_height)
+{}
+
+ImpostorTiles::~ImpostorTiles() {
+    release();
+}
+
+void ImpostorTiles::release() {
+    for (Leaf& l : leaves_) {
+        if (l.texture) SDL_DestroyTexture(l.texture);
+        l.texture = nullptr;
+    }
+}
+
+void ImpostorTiles::build(std::vector<Asset>& all) {
+    release();
+    leaves_.clear();
+
+    for (Asset& a : all) {
+        if (a.merged_sprites.empty()) continue;
+        Leaf leaf;
+        leaf.sprites = a.merged_sprites;
+        leaf.owner = &a;
+        for (const MergedSprite& s : leaf.sprites) {
+            leaf.bounds = rect_union(leaf.bounds, SDL_Rect{ s.x - s.w / 2, s.y - s.h, s.w, s.h });
+        }
+        if (leaf.bounds.w <= 0 || leaf.bounds.h <= 0) continue;
+        leaves_.push_back(std::move(leaf));
+    }
+    std::stable_sort(leaves_.begin(), leaves_.end(),
+                     [](const Leaf& a, const Leaf& b) { return a.owner->z_index < b.owner->z_index; });
+
+    std::cout << "[ImpostorTiles] " << leaves_.size() << " tiles\n";
+}
+
+bool ImpostorTiles::bake(Leaf& leaf, int density_level, std::uint64_t look_key) {
+    int tex_w = 0, tex_h = 0;
+    size_texture(leaf.bounds.w, leaf.bounds.h, density_level, tex_w, tex_h);
+    SDL_Texture* tex = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
+                                         SDL_TEXTUREACCESS_TARGET, tex_w, tex_h);
+    if (!tex) {
+        std::cerr << "[ImpostorTiles] Failed to create " << tex_w << "x" << tex_h
+                  << " tile: " << SDL_GetError() << "\n";
+        return false;
+    }
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(tex, SDL_ScaleModeLinear);
+
+    SDL_Texture* prev_target = SDL_GetRenderTarget(renderer_);
+    SDL_SetRenderTarget(renderer_, tex);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
+    SDL_RenderClear(renderer_);
+
+    // Masks only depend on the frame, so sprites sharing one share its mask.
+    std::unordered_map<SDL_Texture*, SDL_Texture*> masks;
+    const float sx = float(tex_w) / float(leaf.bounds.w);
+    const float sy = float(tex_h) / float(leaf.bounds.h);
+    for (const MergedSprite& s : leaf.sprites) {
+        const SDL_FRect dst{ (s.x - s.w / 2 - leaf.bounds.x) * sx,
+                             (s.y - s.h - leaf.bounds.y) * sy,
+                             s.w * sx, s.h * sy };
+        const SDL_RendererFlip flip = s.flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE;
+
+        // Same tint a live sprite gets; alpha_percentage is tint strength, not opacity.
+        const SDL_Color mod = render_asset_.merged_color_mod(s);
+        SDL_SetTextureColorMod(s.frame, mod.r, mod.g, mod.b);
+        SDL_SetTextureAlphaMod(s.frame, 255);
+        SDL_RenderCopyExF(renderer_, s.frame, nullptr, &dst, 0.0, nullptr, flip);
+        SDL_SetTextureColorMod(s.frame, 255, 255, 255);
+
+        if (!s.shaded) continue;
+        auto it = masks.find(s.frame);
+        if (it == masks.end()) {
+            it = masks.emplace(s.frame, render_asset_.merged_shading_mask(s)).first;
+            SDL_SetRenderTarget(renderer_, tex);
+        }
+        if (it->second) SDL_RenderCopyExF(renderer_, it->second, nullptr, &dst, 0.0, nullptr, flip);
+    }
+    for (auto& [frame, mask] : masks) {
+        if (mask) SDL_DestroyTexture(mask);
+    }
+
+    SDL_SetRenderTarget(renderer_, prev_target);
+    if (leaf.texture) SDL_DestroyTexture(leaf.texture);
+    leaf.texture = tex;
+    leaf.density_level = density_level;
+    leaf.look_key = look_key;
+    return true;
+}
+
+SDL_Rect ImpostorTiles::project(const SDL_Rect& world, float inv_scale) const {
+    // Same mapping as SceneRenderer::get_scaled_position_rect, applied to both corners.
+    const float cx = screen_width_ / 2;
+    const float cy = screen_height_ / 2;
+    const SDL_Point p0 = util_.applyParallax(world.x, world.y);
+    const SDL_Point p1 = util_.applyParallax(world.x + world.w, world.y + world.h);
+    const int x0 = static_cast<int>(std::lround(cx + (p0.x - cx) * inv_scale));
+    const int y0 = static_cast<int>(std::lround(cy + (p0.y - cy) * inv_scale));
+    const int x1 = static_cast<int>(std::lround(cx + (p1.x - cx) * inv_scale));
+    const int y1 = static_cast<int>(std::lround(cy + (p1.y - cy) * inv_scale));
+    return SDL_Rect{ x0, y0, x1 - x0, y1 - y0 };
+}
+
+void ImpostorTiles::prepare(float inv_scale, std::uint64_t look_key, Uint32 now, std::vector<Draw>& out) {
+    out.clear();
+    const int density_level = density_level_for(inv_scale);
+    int rebakes_left = IMPOSTOR_REBAKES_PER_FRAME;
+
+    for (size_t i = 0; i < leaves_.size(); ++i) {
+        Leaf& leaf = leaves_[i];
+        const SDL_Rect dst = project(leaf.bounds, inv_scale);
+        if (dst.w <= 0 || dst.h <= 0 ||
+            dst.x >= screen_width_ || dst.y >= screen_height_ ||
+            dst.x + dst.w <= 0 || dst.y + dst.h <= 0) {
+            continue;
+        }
+
+        if (!leaf.texture) {
+            if (!bake(leaf, density_level, look_key)) continue;
+        } else if ((leaf.look_key != look_key || leaf.density_level != density_level) && rebakes_left > 0) {
+            --rebakes_left;
+            bake(leaf, density_level, look_key);
+        }
+        leaf.last_used_ms = now;
+        out.push_back({ static_cast<int>(i), leaf.owner, dst, leaf.bounds });
+    }
+}
+
+void ImpostorTiles::draw(int leaf, const SDL_Rect& dst) const {
+    SDL_Texture* tex = leaves_[leaf].texture;
+    if (tex) SDL_RenderCopy(renderer_, tex, nullptr, &dst);
+}
+
+std::uint64_t ImpostorTiles::look(int leaf) const {
+    const Leaf& l = leaves_[leaf];
+    std::uint64_t h = HashUtils::SEED;
+    HashUtils::combine_ptr(h, l.texture);
+    HashUtils::combine(h, l.look_key);
+    HashUtils::combine(h, static_cast<std::uint64_t>(l.density_level));
+    return h;
+}
+
+void ImpostorTiles::evict(Uint32 now, Uint32 idle_ms) {
+    for (Leaf& l : leaves_) {
+        if (l.texture && now - l.last_used_ms > idle_ms) {
+            SDL_DestroyTexture(l.texture);
+            l.texture = nullptr;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+// === File: impostor_tiles.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <vector>
+#include "Asset.hpp"
+
+class RenderUtils;
+class RenderAsset;
+
+// Pre-rendered distant boundary tiles. Every asset carrying merged_sprites
+// becomes a leaf holding the tile's sprites, drawn in the asset's place in
+// the z-sorted pass. A leaf bakes its sprites into one texture the first time
+// it is in view: one texel per world pixel at gameplay zoom, halved for each
+// halving of the view scale. Sprites are baked with the tint and shading a
+// live sprite gets for the current look (see prepare); leaves baked for an
+// older look or another density are baked again a few per frame. Idle
+// textures are dropped and baked again on demand.
+class ImpostorTiles {
+public:
+    struct Draw {
+        int leaf;
+        Asset* owner;    // merged asset the leaf stands in for
+        SDL_Rect dst;    // window pixels
+        SDL_Rect world;  // world space bounds
+    };
+
+    ImpostorTiles(SDL_Renderer* renderer, RenderUtils& util, RenderAsset& render_asset,
+                  int screen_width, int screen_height);
+    ~ImpostorTiles();
+
+    ImpostorTiles(const ImpostorTiles&) = delete;
+    ImpostorTiles& operator=(const ImpostorTiles&) = delete;
+
+    // Builds the leaves from the merged assets among all.
+    void build(std::vector<Asset>& all);
+    bool ready() const { return !leaves_.empty(); }
+
+    // Leaves in view at inv_scale, in draw order, baked for look_key (which
+    // must change whenever the lighting baked into the sprites does).
+    void prepare(float inv_scale, std::uint64_t look_key, Uint32 now, std::vector<Draw>& out);
+
+    // Draws a leaf prepared this frame at dst, on the current target.
+    void draw(int leaf, const SDL_Rect& dst) const;
+    // Changes whenever what draw(leaf, ...) shows does.
+    std::uint64_t look(int leaf) const;
+
+    // Releases textures not drawn for idle_ms.
+    void evict(Uint32 now, Uint32 idle_ms);
+
+    size_t leaf_count() const { return leaves_.size(); }
+
+private:
+    struct Leaf {
+        SDL_Rect bounds{0, 0, 0, 0};         // world space
+        std::vector<MergedSprite> sprites;
+        Asset* owner = nullptr;
+        SDL_Texture* texture = nullptr;
+        int density_level = 0;               // texture holds 2^-level texels per world pixel
+        std::uint64_t look_key = 0;          // look texture was baked for
+        Uint32 last_used_ms = 0;
+    };
+
+    bool bake(Leaf& leaf, int density_level, std::uint64_t look_key);
+    SDL_Rect project(const SDL_Rect& world, float inv_scale) const;
+    void release();
+
+    SDL_Renderer* renderer_;
+    RenderUtils& util_;
+    RenderAsset& render_asset_;
+    int screen_width_;
+    int screen_height_;
+    std::vector<Leaf> leaves_;
+};
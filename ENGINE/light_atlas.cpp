@@ -0,0 +1,107 @@
+// === File: light_atlas.cpp ===
+#include "light_atlas.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+constexpr int ATLAS_PADDING = 1;
+}
+
+LightAtlas::LightAtlas(SDL_Renderer* renderer, int size, int max_cell)
+    : renderer_(renderer),
+      size_(size),
+      max_cell_(max_cell)
+{}
+
+LightAtlas::~LightAtlas() {
+    if (atlas_) SDL_DestroyTexture(atlas_);
+}
+
+void LightAtlas::reset() {
+    if (atlas_) SDL_DestroyTexture(atlas_);
+    atlas_ = nullptr;
+    regions_.clear();
+    shelf_x_ = shelf_y_ = shelf_h_ = 0;
+    full_ = false;
+}
+
+bool LightAtlas::ensure_texture() {
+    if (atlas_) return true;
+
+    atlas_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
+                               SDL_TEXTUREACCESS_TARGET, size_, size_);
+    if (!atlas_) {
+        std::cerr << "[LightAtlas] Failed to create atlas: " << SDL_GetError() << "\n";
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas_, SDL_BLENDMODE_ADD);
+    SDL_SetTextureScaleMode(atlas_, SDL_ScaleModeLinear);
+
+    SDL_Texture* prev_target = SDL_GetRenderTarget(renderer_);
+    SDL_SetRenderTarget(renderer_, atlas_);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
+    SDL_RenderClear(renderer_);
+    SDL_SetRenderTarget(renderer_, prev_target);
+    return true;
+}
+
+const SDL_Rect* LightAtlas::find_or_add(SDL_Texture* tex) {
+    if (!tex) return nullptr;
+
+    auto it = regions_.find(tex);
+    if (it != regions_.end()) {
+        return it->second.w > 0 ? &it->second : nullptr;
+    }
+
+    SDL_Rect& region = regions_[tex];
+    region = SDL_Rect{ 0, 0, 0, 0 };
+    if (!ensure_texture()) return nullptr;
+
+    int tw = 0, th = 0;
+    if (SDL_QueryTexture(tex, nullptr, nullptr, &tw, &th) != 0 || tw <= 0 || th <= 0)
+        return nullptr;
+
+    const float fit = std::min(1.0f, static_cast<float>(max_cell_) / std::max(tw, th));
+    const int cw = std::max(1, static_cast<int>(tw * fit));
+    const int ch = std::max(1, static_cast<int>(th * fit));
+    const int pw = cw + ATLAS_PADDING * 2;
+    const int ph = ch + ATLAS_PADDING * 2;
+
+    if (shelf_x_ + pw > size_) {
+        shelf_y_ += shelf_h_;
+        shelf_x_ = 0;
+        shelf_h_ = 0;
+    }
+    if (pw > size_ || shelf_y_ + ph > size_) {
+        if (pw <= size_ && !full_) {
+            std::cerr << "[LightAtlas] Atlas full, further sprites drawn unbatched\n";
+            full_ = true;
+        }
+        return nullptr;
+    }
+
+    region = SDL_Rect{ shelf_x_ + ATLAS_PADDING, shelf_y_ + ATLAS_PADDING, cw, ch };
+    shelf_x_ += pw;
+    shelf_h_ = std::max(shelf_h_, ph);
+
+    SDL_BlendMode prev_mode = SDL_BLENDMODE_NONE;
+    Uint8 prev_alpha = 255, prev_r = 255, prev_g = 255, prev_b = 255;
+    SDL_GetTextureBlendMode(tex, &prev_mode);
+    SDL_GetTextureAlphaMod(tex, &prev_alpha);
+    SDL_GetTextureColorMod(tex, &prev_r, &prev_g, &prev_b);
+
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
+    SDL_SetTextureAlphaMod(tex, 255);
+    SDL_SetTextureColorMod(tex, 255, 255, 255);
+
+    SDL_Texture* prev_target = SDL_GetRenderTarget(renderer_);
+    SDL_SetRenderTarget(renderer_, atlas_);
+    SDL_RenderCopy(renderer_, tex, nullptr, &region);
+    SDL_SetRenderTarget(renderer_, prev_target);
+
+    SDL_SetTextureBlendMode(tex, prev_mode);
+    SDL_SetTextureAlphaMod(tex, prev_alpha);
+    SDL_SetTextureColorMod(tex, prev_r, prev_g, prev_b);
+
+    return &region;
+}
@@ -0,0 +1,51 @@
+// === File: light_atlas.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <unordered_map>
+
+// Packs light sprites into one render-target texture so the light map can
+// accumulate every light with a single SDL_RenderGeometry call (also used for
+// the shadow silhouettes of CastShadowPass). Sprites are
+// copied in on first use, downscaled to at most max_cell pixels on their long
+// side; light falloffs are smooth, so the loss is not visible on the low-res
+// light map. Regions are keyed by the source texture, which must outlive the
+// atlas (light textures live as long as their AssetInfo).
+class LightAtlas {
+public:
+    LightAtlas(SDL_Renderer* renderer, int size = 2048, int max_cell = 256);
+    ~LightAtlas();
+
+    LightAtlas(const LightAtlas&) = delete;
+    LightAtlas& operator=(const LightAtlas&) = delete;
+
+    // Region of tex inside the atlas, or nullptr if it does not fit.
+    // May switch the render target; call outside of other target passes.
+    const SDL_Rect* find_or_add(SDL_Texture* tex);
+
+    // Drops every region and the texture, so sprites are packed again from
+    // scratch on their next find_or_add.
+    void reset();
+    // A sprite did not fit for lack of space since the last reset.
+    bool is_full() const { return full_; }
+
+    SDL_Texture* get_texture() const { return atlas_; }
+    int get_size() const { return size_; }
+
+private:
+    bool ensure_texture();
+
+    SDL_Renderer* renderer_;
+    SDL_Texture* atlas_ = nullptr;
+    int size_;
+    int max_cell_;
+
+    // Shelf packer state
+    int shelf_x_ = 0;
+    int shelf_y_ = 0;
+    int shelf_h_ = 0;
+    bool full_ = false;
+
+    // Empty rect = did not fit, so it is not retried every frame.
+    std::unordered_map<SDL_Texture*, SDL_Rect> regions_;
+};
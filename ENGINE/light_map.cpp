@@ -1,7 +1,8 @@
 // === File: light_z_pass.cpp ===
 #include "light_map.hpp"
+#include "light_utils.hpp"
+#include "hash_utils.hpp"
 #include <algorithm>
-#include <random>
 #include <vector>
 #include <iostream>
 
@@ -18,40 +19,55 @@ LightMap::LightMap(SDL_Renderer* renderer,
       main_light_(main_light),
       screen_width_(screen_width),
       screen_height_(screen_height),
-      fullscreen_light_tex_(fullscreen_light_tex)
+      fullscreen_light_tex_(fullscreen_light_tex),
+      atlas_(renderer)
 {}
 
+LightMap::~LightMap() {
+    if (lowres_mask_) SDL_DestroyTexture(lowres_mask_);
+}
+
 void LightMap::render(bool debugging) {
     if (debugging) std::cout << "[render_asset_lights_z] start\n";
+    prepare();
+    composite();
+    if (debugging) std::cout << "[render_asset_lights_z] end\n";
+}
 
-    static std::mt19937 flicker_rng{ std::random_device{}() };
-    static std::vector<LightEntry> z_lights;
-    z_lights.clear();
-
-    collect_layers(z_lights, flicker_rng);
+void LightMap::prepare() {
+    layers_.clear();
+    collect_layers(layers_);
 
-    // Downscale disabled here for speed (kept at 1)
-    const int downscale = 4;
+    SDL_Texture* out_target = SDL_GetRenderTarget(renderer_);
+    const int downscale = downscale_;
     const int low_w = screen_width_  / downscale;
     const int low_h = screen_height_ / downscale;
 
-    SDL_Texture* lowres_mask = build_lowres_mask(z_lights, low_w, low_h, downscale);
-
-    SDL_SetTextureBlendMode(lowres_mask, SDL_BLENDMODE_MOD);
-    SDL_SetRenderTarget(renderer_, nullptr);
-    SDL_RenderCopy(renderer_, lowres_mask, nullptr, nullptr);
-
-    SDL_DestroyTexture(lowres_mask);
+    // Nothing moved, dimmed or flickered since the last build: composite the old mask.
+    const std::uint64_t hash = hash_layers(layers_, low_w, low_h);
+    if (lowres_mask_ && hash == lowres_hash_ && low_w == low_w_ && low_h == low_h_) {
+        mask_ = lowres_mask_;
+    } else {
+        mask_ = build_lowres_mask(layers_, low_w, low_h, downscale);
+        lowres_hash_ = mask_ ? hash : 0;
+    }
+    SDL_SetRenderTarget(renderer_, out_target);
+}
 
-    if (debugging) std::cout << "[render_asset_lights_z] end\n";
+void LightMap::composite(const SDL_Rect* clip) {
+    if (!mask_) return;
+    SDL_SetTextureBlendMode(mask_, SDL_BLENDMODE_MOD);
+    if (clip) SDL_RenderSetClipRect(renderer_, clip);
+    SDL_RenderCopy(renderer_, mask_, nullptr, nullptr);
 }
 
-void LightMap::collect_layers(std::vector<LightEntry>& out, std::mt19937& rng) {
+void LightMap::collect_layers(std::vector<LightEntry>& out) {
     const float inv_scale = 1.0f / assets_->getView().get_scale();
     constexpr int min_visible_w = 1;
     constexpr int min_visible_h = 1;
 
-    Uint8 main_alpha = main_light_.get_current_color().a;
+    // Drawn every frame, so follow the day/night crossfade rather than the state.
+    Uint8 main_alpha = main_light_.get_blended_color().a;
 
     // Fullscreen light tex
     if (fullscreen_light_tex_) {
@@ -74,57 +90,115 @@ void LightMap::collect_layers(std::vector<LightEntry>& out, std::mt19937& rng) {
         }
     }
 
-    // Asset lights
-    for (Asset* a : assets_->active_assets) {
-        if (!a || !a->info || !a->info->has_light_source) continue;
+    const SDL_Rect screen_rect{ 0, 0, screen_width_, screen_height_ };
+    auto push_light = [&](Asset* a, const LightSource& light) {
+        int offX = a->flipped ? -light.offset_x : light.offset_x;
+        int lw = light.cached_w, lh = light.cached_h;
+        if (lw == 0 || lh == 0) SDL_QueryTexture(light.texture, nullptr, nullptr, &lw, &lh);
 
-        for (const auto& light : a->info->light_sources) {
-            if (!light.texture) continue;
+        SDL_Rect dst = get_scaled_position_rect({ a->pos_X + offX, a->pos_Y + light.offset_y },
+                                                lw, lh, inv_scale,
+                                                min_visible_w, min_visible_h);
+        if (dst.w == 0 && dst.h == 0) return;
+        if (!SDL_HasIntersection(&dst, &screen_rect)) return;
 
-            int offX = a->flipped ? -light.offset_x : light.offset_x;
-            int lw = light.cached_w, lh = light.cached_h;
-            if (lw == 0 || lh == 0) SDL_QueryTexture(light.texture, nullptr, nullptr, &lw, &lh);
+        float alpha_f = static_cast<float>(main_light_.get_blended_brightness());
+        if (a == assets_->player) alpha_f *= 0.9f;
+        alpha_f *= LightUtils::flicker_scale(light, flicker_phase_, a);
 
-            SDL_Rect dst = get_scaled_position_rect({ a->pos_X + offX, a->pos_Y + light.offset_y },
-                                                    lw, lh, inv_scale,
-                                                    min_visible_w, min_visible_h);
-            if (dst.w == 0 && dst.h == 0) continue;
+        Uint8 alpha = static_cast<Uint8>(std::clamp(alpha_f, 0.0f, 255.0f));
+        out.push_back({ light.texture, dst, alpha,
+                        a->flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE, true });
+    };
 
-            float alpha_f = static_cast<float>(main_light_.get_brightness());
-            if (a == assets_->player) alpha_f *= 0.9f;
+    // Static asset lights: everything whose bounds touch the zoomed view,
+    // including lights whose owner is off-screen.
+    Asset* player = assets_->player;
+    const int cam_x = player ? player->pos_X : 0;
+    const int cam_y = player ? player->pos_Y : 0;
+    const float scale = assets_->getView().get_scale();
+    const int half_w = static_cast<int>(screen_width_  * 0.5f * scale) + 1;
+    const int half_h = static_cast<int>(screen_height_ * 0.5f * scale) + 1;
+    const SDL_Rect world_view{ cam_x - half_w, cam_y - half_h, half_w * 2, half_h * 2 };
 
-            if (light.flicker > 0) {
-                float intensity_scale = std::clamp(light.intensity / 255.0f, 0.0f, 1.0f);
-                float max_jitter = (light.flicker / 100.0f) * intensity_scale;
-                alpha_f *= (1.0f + std::uniform_real_distribution<float>(-max_jitter, max_jitter)(rng));
-            }
+    visible_lights_.clear();
+    assets_->light_registry.query(world_view, visible_lights_);
+    for (const LightRegistry::Entry* e : visible_lights_) {
+        push_light(e->owner, *e->light);
+    }
 
-            Uint8 alpha = static_cast<Uint8>(std::clamp(alpha_f, 0.0f, 255.0f));
-            out.push_back({ light.texture, dst, alpha,
-                            a->flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE, true });
+    // The player moves, so its lights are not in the registry.
+    if (player && player->info && player->info->has_light_source) {
+        for (const auto& light : player->info->light_sources) {
+            if (light.texture) push_light(player, light);
         }
     }
 }
 
+std::uint64_t LightMap::hash_layers(const std::vector<LightEntry>& layers,
+                                    int low_w, int low_h) const {
+    std::uint64_t h = HashUtils::SEED;
+    HashUtils::combine(h, (std::uint64_t(std::uint32_t(low_w)) << 32) | std::uint32_t(low_h));
+
+    const SDL_Color tint = main_light_.get_blended_tint();
+    HashUtils::combine(h, (std::uint64_t(tint.r) << 24) | (std::uint64_t(tint.g) << 16) |
+                          (std::uint64_t(tint.b) << 8)  |  std::uint64_t(tint.a));
+
+    for (const auto& e : layers) {
+        HashUtils::combine_ptr(h, e.tex);
+        HashUtils::combine(h, (std::uint64_t(std::uint32_t(e.dst.x)) << 32) | std::uint32_t(e.dst.y));
+        HashUtils::combine(h, (std::uint64_t(std::uint32_t(e.dst.w)) << 32) | std::uint32_t(e.dst.h));
+        HashUtils::combine(h, (std::uint64_t(e.alpha) << 16) | (std::uint64_t(e.flip) << 1) |
+                              std::uint64_t(e.apply_tint));
+    }
+    return h;
+}
+
+bool LightMap::ensure_lowres_target(int low_w, int low_h) {
+    if (lowres_mask_ && low_w_ == low_w && low_h_ == low_h) return true;
+
+    if (lowres_mask_) SDL_DestroyTexture(lowres_mask_);
+    lowres_mask_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
+                                     SDL_TEXTUREACCESS_TARGET, low_w, low_h);
+    if (!lowres_mask_) {
+        std::cerr << "[LightMap] Failed to create low-res target: " << SDL_GetError() << "\n";
+        low_w_ = low_h_ = 0;
+        return false;
+    }
+    low_w_ = low_w;
+    low_h_ = low_h;
+    return true;
+}
+
 SDL_Texture* LightMap::build_lowres_mask(const std::vector<LightEntry>& layers,
                                          int low_w, int low_h, int downscale) {
-    SDL_Texture* lowres_mask = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
-                                                 SDL_TEXTUREACCESS_TARGET, low_w, low_h);
-    SDL_SetTextureBlendMode(lowres_mask, SDL_BLENDMODE_NONE);
-    SDL_SetRenderTarget(renderer_, lowres_mask);
+    // Resolve atlas regions first; adding a sprite switches the render target.
+    std::vector<const SDL_Rect*> regions(layers.size(), nullptr);
+    for (size_t i = 0; i < layers.size(); ++i) {
+        if (layers[i].apply_tint) regions[i] = atlas_.find_or_add(layers[i].tex);
+    }
+
+    if (!ensure_lowres_target(low_w, low_h)) return nullptr;
+
+    SDL_SetTextureBlendMode(lowres_mask_, SDL_BLENDMODE_NONE);
+    SDL_SetRenderTarget(renderer_, lowres_mask_);
     SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
     SDL_RenderClear(renderer_);
     SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_ADD);
 
-    for (auto& e : layers) {
-        SDL_SetTextureBlendMode(e.tex, SDL_BLENDMODE_ADD);
-        SDL_SetTextureAlphaMod(e.tex, e.alpha);
+    batch_vertices_.clear();
+    batch_indices_.clear();
+    const float inv_atlas = 1.0f / atlas_.get_size();
+
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const LightEntry& e = layers[i];
 
+        SDL_Color color{ 255, 255, 255, e.alpha };
         if (e.apply_tint) {
-            SDL_Color tinted = main_light_.apply_tint_to_color({255, 255, 255, 255}, e.alpha);
-            SDL_SetTextureColorMod(e.tex, tinted.r, tinted.g, tinted.b);
-        } else {
-            SDL_SetTextureColorMod(e.tex, 255, 255, 255);
+            SDL_Color tinted = main_light_.apply_blended_tint_to_color({255, 255, 255, 255}, e.alpha);
+            color.r = tinted.r;
+            color.g = tinted.g;
+            color.b = tinted.b;
         }
 
         SDL_Rect scaled_dst{
@@ -133,10 +207,43 @@ SDL_Texture* LightMap::build_lowres_mask(const std::vector<LightEntry>& layers,
             e.dst.w / downscale,
             e.dst.h / downscale
         };
+
+        if (const SDL_Rect* r = regions[i]) {
+            // Half-texel inset keeps linear filtering inside the cell.
+            float u0 = (r->x + 0.5f) * inv_atlas;
+            float u1 = (r->x + r->w - 0.5f) * inv_atlas;
+            const float v0 = (r->y + 0.5f) * inv_atlas;
+            const float v1 = (r->y + r->h - 0.5f) * inv_atlas;
+            if (e.flip & SDL_FLIP_HORIZONTAL) std::swap(u0, u1);
+
+            const float x0 = static_cast<float>(scaled_dst.x);
+            const float y0 = static_cast<float>(scaled_dst.y);
+            const float x1 = x0 + scaled_dst.w;
+            const float y1 = y0 + scaled_dst.h;
+
+            const int base = static_cast<int>(batch_vertices_.size());
+            batch_vertices_.push_back({ { x0, y0 }, color, { u0, v0 } });
+            batch_vertices_.push_back({ { x1, y0 }, color, { u1, v0 } });
+            batch_vertices_.push_back({ { x1, y1 }, color, { u1, v1 } });
+            batch_vertices_.push_back({ { x0, y1 }, color, { u0, v1 } });
+            batch_indices_.insert(batch_indices_.end(),
+                                  { base, base + 1, base + 2, base, base + 2, base + 3 });
+            continue;
+        }
+
+        SDL_SetTextureBlendMode(e.tex, SDL_BLENDMODE_ADD);
+        SDL_SetTextureAlphaMod(e.tex, color.a);
+        SDL_SetTextureColorMod(e.tex, color.r, color.g, color.b);
         SDL_RenderCopyEx(renderer_, e.tex, nullptr, &scaled_dst, 0, nullptr, e.flip);
     }
 
-    return lowres_mask;
+    if (!batch_indices_.empty()) {
+        SDL_RenderGeometry(renderer_, atlas_.get_texture(),
+                           batch_vertices_.data(), static_cast<int>(batch_vertices_.size()),
+                           batch_indices_.data(), static_cast<int>(batch_indices_.size()));
+    }
+
+    return lowres_mask_;
 }
 
 SDL_Rect LightMap::get_scaled_position_rect(const std::pair<int,int>& pos, int fw, int fh,
@@ -3,10 +3,12 @@
 
 #include <SDL.h>
 #include <vector>
-#include <random>
+#include <algorithm>
+#include <cstdint>
 #include "assets.hpp"
 #include "render_utils.hpp"
 #include "global_light_source.hpp"
+#include "light_atlas.hpp"
 
 class LightMap {
 public:
@@ -25,11 +27,35 @@ public:
              int screen_width,
              int screen_height,
              SDL_Texture* fullscreen_light_tex);
+    ~LightMap();
+
+    LightMap(const LightMap&) = delete;
+    LightMap& operator=(const LightMap&) = delete;
 
     void render(bool debugging);
 
+    // render() in two steps, so the mask can be composited region by region:
+    // prepare() collects the lights and rebuilds the mask if they changed,
+    // composite() multiplies it onto the current target (within clip if given).
+    void prepare();
+    void composite(const SDL_Rect* clip = nullptr);
+
+    // Lights that went into the current mask.
+    const std::vector<LightEntry>& get_layers() const { return layers_; }
+
+    // Flicker phase (see LightUtils::flicker_scale); changes at most every
+    // FLICKER_INTERVAL_FRAMES, so the mask can be reused in between.
+    void set_flicker_phase(std::uint32_t phase) { flicker_phase_ = phase; }
+
+    // Screen pixels per light map pixel; raised by the frame-time controller
+    // under load. The mask is composited over whatever target is current.
+    void set_downscale(int downscale) { downscale_ = std::max(1, downscale); }
+    int  get_downscale() const { return downscale_; }
+
 private:
-    void collect_layers(std::vector<LightEntry>& out, std::mt19937& rng);
+    void collect_layers(std::vector<LightEntry>& out);
+    std::uint64_t hash_layers(const std::vector<LightEntry>& layers, int low_w, int low_h) const;
+    bool ensure_lowres_target(int low_w, int low_h);
     SDL_Texture* build_lowres_mask(const std::vector<LightEntry>& layers,
                                    int low_w, int low_h, int downscale);
 
@@ -42,4 +68,22 @@ SDL_Rect get_scaled_position_rect(const std::pair<int,int>& pos, int fw, int fh,
     int screen_width_;
     int screen_height_;
     SDL_Texture* fullscreen_light_tex_;
+
+    // Kept across frames; recreated only when the low-res size changes.
+    SDL_Texture* lowres_mask_ = nullptr;
+    int low_w_ = 0;
+    int low_h_ = 0;
+    std::uint64_t lowres_hash_ = 0;   // hash_layers() of what lowres_mask_ holds
+
+    std::uint32_t flicker_phase_ = 0;
+    int downscale_ = 4;
+
+    std::vector<const LightRegistry::Entry*> visible_lights_;
+    std::vector<LightEntry> layers_;
+    SDL_Texture* mask_ = nullptr;   // set by prepare(), lowres_mask_ or nullptr
+
+    // Asset lights are accumulated in one geometry batch from the atlas.
+    LightAtlas atlas_;
+    std::vector<SDL_Vertex> batch_vertices_;
+    std::vector<int> batch_indices_;
 };
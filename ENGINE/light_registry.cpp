@@ -0,0 +1,96 @@
+// === File: light_registry.cpp ===
+#include "light_registry.hpp"
+#include "Asset.hpp"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <unordered_set>
+
+LightRegistry::LightRegistry(int cell_size)
+    : cell_size_(std::max(1, cell_size))
+{}
+
+int LightRegistry::cell_of(int v) const {
+    // floor division so negative coordinates land in the right cell
+    return (v >= 0) ? v / cell_size_ : -((-v + cell_size_ - 1) / cell_size_);
+}
+
+void LightRegistry::build(std::vector<Asset>& all, const Asset* skip) {
+    entries_.clear();
+    cells_.clear();
+
+    std::unordered_set<const Asset*> visited;
+    std::function<void(Asset&)> add = [&](Asset& owner) {
+        if (!visited.insert(&owner).second) return;
+
+        if (&owner != skip && owner.info && owner.info->has_light_source) {
+            for (const LightSource& light : owner.info->light_sources) {
+                if (!light.texture) continue;
+
+                int lw = light.cached_w, lh = light.cached_h;
+                if (lw == 0 || lh == 0) SDL_QueryTexture(light.texture, nullptr, nullptr, &lw, &lh);
+
+                const int off_x = owner.flipped ? -light.offset_x : light.offset_x;
+                entries_.push_back({ &owner, &light,
+                                     owner.pos_X + off_x,
+                                     owner.pos_Y + light.offset_y,
+                                     std::max(lw, lh) / 2 });
+            }
+        }
+        for (Asset* child : owner.children) {
+            if (child) add(*child);
+        }
+    };
+    for (Asset& a : all) add(a);
+
+    for (std::uint32_t i = 0; i < entries_.size(); ++i) {
+        const Entry& e = entries_[i];
+        const int x0 = cell_of(e.x - e.radius), x1 = cell_of(e.x + e.radius);
+        const int y0 = cell_of(e.y - e.radius), y1 = cell_of(e.y + e.radius);
+        for (int cy = y0; cy <= y1; ++cy)
+            for (int cx = x0; cx <= x1; ++cx)
+                cells_[make_key(cx, cy)].push_back(i);
+    }
+
+    seen_.assign(entries_.size(), 0);
+    stamp_ = 0;
+
+    std::cout << "[LightRegistry] " << entries_.size() << " lights in "
+              << cells_.size() << " cells\n";
+}
+
+void LightRegistry::query(const SDL_Rect& world_rect, std::vector<const Entry*>& out) const {
+    if (entries_.empty()) return;
+
+    if (++stamp_ == 0) {
+        std::fill(seen_.begin(), seen_.end(), 0);
+        stamp_ = 1;
+    }
+    hits_.clear();
+
+    const int rx0 = world_rect.x, rx1 = world_rect.x + world_rect.w;
+    const int ry0 = world_rect.y, ry1 = world_rect.y + world_rect.h;
+
+    for (int cy = cell_of(ry0); cy <= cell_of(ry1); ++cy) {
+        for (int cx = cell_of(rx0); cx <= cell_of(rx1); ++cx) {
+            auto it = cells_.find(make_key(cx, cy));
+            if (it == cells_.end()) continue;
+
+            for (std::uint32_t i : it->second) {
+                if (seen_[i] == stamp_) continue;
+                seen_[i] = stamp_;
+
+                // circle vs rect: distance from centre to the clamped point
+                const Entry& e = entries_[i];
+                const long long dx = e.x - std::clamp(e.x, rx0, rx1);
+                const long long dy = e.y - std::clamp(e.y, ry0, ry1);
+                if (dx * dx + dy * dy <= static_cast<long long>(e.radius) * e.radius)
+                    hits_.push_back(i);
+            }
+        }
+    }
+
+    // Stable order keeps LightMap's change hash stable as cells come and go.
+    std::sort(hits_.begin(), hits_.end());
+    for (std::uint32_t i : hits_) out.push_back(&entries_[i]);
+}
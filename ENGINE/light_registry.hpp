@@ -0,0 +1,54 @@
+// === File: light_registry.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Asset;
+struct LightSource;
+
+// World-space index of the lights attached to static assets. Each light is
+// stored with its bounding circle in every grid cell the circle overlaps, so
+// the light pass can fetch exactly the lights touching the view instead of
+// walking the active assets (which misses large lights owned by off-screen
+// assets). Moving owners (the player) are skipped and handled per frame.
+class LightRegistry {
+public:
+    struct Entry {
+        Asset* owner;
+        const LightSource* light;
+        int x;        // world-space centre
+        int y;
+        int radius;   // bounding circle of the light texture
+    };
+
+    explicit LightRegistry(int cell_size = 1024);
+
+    void build(std::vector<Asset>& all, const Asset* skip);
+
+    // Appends entries whose bounding circle intersects world_rect, each once,
+    // in registration order.
+    void query(const SDL_Rect& world_rect, std::vector<const Entry*>& out) const;
+
+    std::size_t size() const { return entries_.size(); }
+
+private:
+    using CellKey = std::uint64_t;
+
+    static CellKey make_key(int cx, int cy) {
+        return (static_cast<CellKey>(static_cast<std::uint32_t>(cx)) << 32) |
+                static_cast<std::uint32_t>(cy);
+    }
+    int cell_of(int v) const;
+
+    int cell_size_;
+    std::vector<Entry> entries_;
+    std::unordered_map<CellKey, std::vector<std::uint32_t>> cells_;
+
+    // Query-stamp dedupe for lights that span several cells.
+    mutable std::vector<std::uint32_t> seen_;
+    mutable std::uint32_t stamp_ = 0;
+    mutable std::vector<std::uint32_t> hits_;
+};
@@ -15,6 +15,7 @@ struct LightSource {
     int offset_y = 0;
     int x_radius = 0;
     int y_radius = 0;
+    int max_resolution = 256;  // generated texture side cap; drawn at 2 * radius
     int cached_w = 0;
     int cached_h = 0;
     SDL_Color color = {255, 255, 255, 255};
@@ -1,7 +1,9 @@
 // light_utils.hpp
 #pragma once
 #include <algorithm>
+#include <cstdint>
 #include "Asset.hpp" // or forward declare if possible
+#include "hash_utils.hpp"
 
 namespace LightUtils {
 
@@ -29,4 +31,24 @@ inline double calculate_static_alpha_percentage(const Asset* assetA, const Asset
     return std::clamp(factor, MIN_OPACITY, MAX_OPACITY);
 }
 
+// Flicker is re-rolled once every FLICKER_INTERVAL_FRAMES and is a pure function of
+// (light, phase), so a regenerated texture only changes when the phase does.
+// instance decorrelates lights shared through one AssetInfo (e.g. every torch).
+constexpr int FLICKER_INTERVAL_FRAMES = 3;
+
+inline float flicker_scale(const LightSource& light, std::uint32_t phase,
+                           const void* instance = nullptr) {
+    if (light.flicker <= 0) return 1.0f;
+
+    std::uint64_t h = HashUtils::SEED;
+    HashUtils::combine_ptr(h, &light);
+    if (instance) HashUtils::combine_ptr(h, instance);
+    HashUtils::combine(h, phase);
+    const float unit = float(h >> 40) / float(1u << 24) * 2.0f - 1.0f;
+
+    const float brightness_scale = std::clamp(light.intensity / 255.0f, 0.0f, 1.0f);
+    const float max_jitter = (light.flicker / 100.0f) * brightness_scale;
+    return 1.0f + unit * max_jitter;
+}
+
 } // namespace LightUtils
@@ -0,0 +1,31 @@
+// === File: lit_texture_cache.cpp ===
+#include "lit_texture_cache.hpp"
+
+static constexpr int PRUNE_INTERVAL = 256;
+
+std::shared_ptr<SDL_Texture> LitTextureCache::find(std::uint64_t key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return nullptr;
+
+    std::shared_ptr<SDL_Texture> tex = it->second.lock();
+    if (!tex) entries_.erase(it);
+    return tex;
+}
+
+std::shared_ptr<SDL_Texture> LitTextureCache::insert(std::uint64_t key, SDL_Texture* tex) {
+    if (!tex) return nullptr;
+
+    std::shared_ptr<SDL_Texture> shared(tex, SDL_DestroyTexture);
+    entries_[key] = shared;
+
+    if (++inserts_since_prune_ >= PRUNE_INTERVAL) prune();
+    return shared;
+}
+
+void LitTextureCache::prune() {
+    inserts_since_prune_ = 0;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.expired()) it = entries_.erase(it);
+        else ++it;
+    }
+}
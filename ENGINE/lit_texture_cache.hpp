@@ -0,0 +1,27 @@
+// === File: lit_texture_cache.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+// Final (lit) textures keyed by the hash of everything they were baked from.
+// Instances that resolve to the same key share one reference-counted texture;
+// the cache itself only holds weak references, so a texture is destroyed as
+// soon as the last asset drops it.
+class LitTextureCache {
+public:
+    std::shared_ptr<SDL_Texture> find(std::uint64_t key);
+
+    // Takes ownership of tex.
+    std::shared_ptr<SDL_Texture> insert(std::uint64_t key, SDL_Texture* tex);
+
+    void prune();
+    std::size_t size() const { return entries_.size(); }
+
+private:
+    std::unordered_map<std::uint64_t, std::weak_ptr<SDL_Texture>> entries_;
+    int inserts_since_prune_ = 0;
+};
@@ -0,0 +1,132 @@
+// === File: map_impostor.cpp ===
+#include "map_impostor.hpp"
+#include "Asset.hpp"
+#include "render_asset.hpp"
+#include "render_utils.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+constexpr int IMPOSTOR_LEVELS = 2;
+// On-screen size below which the live intro pass skips a sprite. A level is
+// magnified down to the smallest scale it serves, so it keeps every sprite
+// that reaches this size there.
+constexpr float IMPOSTOR_MIN_SIZE = 20.0f;
+}
+
+MapImpostor::MapImpostor(SDL_Renderer* renderer, RenderUtils& util, const RenderAsset& render_asset,
+                         int screen_width, int screen_height)
+    : renderer_(renderer),
+      util_(util),
+      render_asset_(render_asset),
+      screen_width_(screen_width),
+      screen_height_(screen_height)
+{}
+
+MapImpostor::~MapImpostor() {
+    release();
+}
+
+void MapImpostor::release() {
+    for (Level& level : levels_) {
+        if (level.texture) SDL_DestroyTexture(level.texture);
+    }
+    levels_.clear();
+}
+
+void MapImpostor::draw_assets(float scale, float min_size, const std::vector<Asset*>& assets) const {
+    const float inv_scale = 1.0f / scale;
+    const int cx = screen_width_ / 2;
+    const int cy = screen_height_ / 2;
+
+    for (Asset* a : assets) {
+        SDL_Texture* frame = a->get_current_frame();
+        if (!frame) continue;
+
+        int fw = a->cached_w;
+        int fh = a->cached_h;
+        if (fw == 0 || fh == 0) SDL_QueryTexture(frame, nullptr, nullptr, &fw, &fh);
+        if (fw * inv_scale < min_size && fh * inv_scale < min_size) continue;
+        const int sw = std::max(1, static_cast<int>(fw * inv_scale));
+        const int sh = std::max(1, static_cast<int>(fh * inv_scale));
+
+        SDL_Point cp = util_.applyParallax(a->pos_X, a->pos_Y);
+        cp.x = cx + static_cast<int>((cp.x - cx) * inv_scale);
+        cp.y = cy + static_cast<int>((cp.y - cy) * inv_scale);
+        const SDL_Rect dst{ cp.x - sw / 2, cp.y - sh, sw, sh };
+        if (dst.x >= screen_width_ || dst.y >= screen_height_ || dst.x + sw <= 0 || dst.y + sh <= 0) continue;
+
+        // Same look as the live pass: the lit bake where the asset has one
+        // (SceneRenderer::bake_impostor makes sure of it), the tinted frame
+        // otherwise.
+        const SDL_RendererFlip flip = a->flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE;
+        const bool uniform = render_asset_.is_uniformly_lit(a);
+        if (SDL_Texture* final_tex = uniform ? nullptr : a->get_final_texture()) {
+            SDL_RenderCopyEx(renderer_, final_tex, nullptr, &dst, 0, nullptr, flip);
+            continue;
+        }
+        SDL_Texture* tex = a->get_current_frame_lod(sw, sh);
+        const SDL_Color mod = uniform ? render_asset_.uniform_color_mod(a)
+                                      : render_asset_.ambient_color_mod(a);
+        SDL_SetTextureColorMod(tex, mod.r, mod.g, mod.b);
+        SDL_SetTextureAlphaMod(tex, mod.a);
+        SDL_RenderCopyEx(renderer_, tex, nullptr, &dst, 0, nullptr, flip);
+        SDL_SetTextureColorMod(tex, 255, 255, 255);
+        SDL_SetTextureAlphaMod(tex, 255);
+    }
+}
+
+bool MapImpostor::bake(float scale, float min_scale, const std::vector<Asset*>& assets) {
+    release();
+    if (scale <= 0.0f) return false;
+    min_scale = std::clamp(min_scale, 0.0f, scale);
+
+    SDL_Texture* prev_target = SDL_GetRenderTarget(renderer_);
+    float level_scale = scale;
+    for (int i = 0; i < IMPOSTOR_LEVELS; ++i, level_scale *= 0.5f) {
+        SDL_Texture* tex = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
+                                             SDL_TEXTUREACCESS_TARGET, screen_width_, screen_height_);
+        if (!tex) {
+            std::cerr << "[MapImpostor] Failed to create level " << i << ": " << SDL_GetError() << "\n";
+            break;
+        }
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(tex, SDL_ScaleModeLinear);
+
+        SDL_SetRenderTarget(renderer_, tex);
+        SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
+        SDL_RenderClear(renderer_);
+        // Served down to the next level's scale, the last one down to min_scale.
+        const float lowest = (i + 1 < IMPOSTOR_LEVELS) ? level_scale * 0.5f : std::min(min_scale, level_scale);
+        draw_assets(level_scale, IMPOSTOR_MIN_SIZE * lowest / level_scale, assets);
+        levels_.push_back({ tex, level_scale });
+    }
+    SDL_SetRenderTarget(renderer_, prev_target);
+
+    if (!levels_.empty()) {
+        std::cout << "[MapImpostor] Baked " << levels_.size() << " level(s) of "
+                  << assets.size() << " assets at scale " << scale << "\n";
+    }
+    return ready();
+}
+
+void MapImpostor::render(float scale, float target_scale, Uint8 alpha) const {
+    if (levels_.empty() || scale <= 0.0f || alpha == 0) return;
+
+    // Smallest baked scale that still covers the whole view.
+    const Level* level = &levels_.front();
+    for (const Level& l : levels_) {
+        if (l.scale >= scale) level = &l;
+    }
+
+    const float m = level->scale / scale * target_scale;
+    const float w = screen_width_ * m;
+    const float h = screen_height_ * m;
+    const SDL_FRect dst{ screen_width_ * target_scale * 0.5f - w * 0.5f,
+                         screen_height_ * target_scale * 0.5f - h * 0.5f, w, h };
+
+    SDL_SetTextureAlphaMod(level->texture, alpha);
+    SDL_RenderCopyF(renderer_, level->texture, nullptr, &dst);
+    SDL_SetTextureAlphaMod(level->texture, 255);
+}
@@ -0,0 +1,52 @@
+// === File: map_impostor.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+class Asset;
+class RenderAsset;
+class RenderUtils;
+
+// Pre-rendered overview of the whole map for the intro zoom. The view
+// projection (parallax included) is linear around the screen centre, so a
+// screen-sized picture baked at one view scale can stand in for any larger
+// scale by magnifying it. Two levels are baked, the second at half the scale
+// of the first, so the picture stays sharp until live rendering takes over.
+class MapImpostor {
+public:
+    MapImpostor(SDL_Renderer* renderer, RenderUtils& util, const RenderAsset& render_asset,
+                int screen_width, int screen_height);
+    ~MapImpostor();
+
+    MapImpostor(const MapImpostor&) = delete;
+    MapImpostor& operator=(const MapImpostor&) = delete;
+
+    // Draws assets (in draw order) at view scale and scale / 2; the impostor
+    // is shown down to view scale min_scale. Leaves the current render
+    // target untouched.
+    bool bake(float scale, float min_scale, const std::vector<Asset*>& assets);
+
+    // Draws the sharpest level covering the view at scale onto the current
+    // target, whose size is the window size times target_scale.
+    void render(float scale, float target_scale, Uint8 alpha) const;
+
+    bool ready() const { return !levels_.empty(); }
+    void release();
+
+private:
+    struct Level {
+        SDL_Texture* texture;
+        float scale;
+    };
+
+    // Skips sprites smaller than min_size pixels (both sides) at scale.
+    void draw_assets(float scale, float min_size, const std::vector<Asset*>& assets) const;
+
+    SDL_Renderer* renderer_;
+    RenderUtils& util_;
+    const RenderAsset& render_asset_;
+    int screen_width_;
+    int screen_height_;
+    std::vector<Level> levels_;   // largest scale first
+};
@@ -0,0 +1,740 @@
+// === File: pixel_kernels.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// SSE2 is assumed wherever the compiler targets it (always on x86-64); AVX2
+// is compiled per function and only called after the runtime check.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_KERNELS_AVX2 __attribute__((target("avx2")))
+#else
+#define PIXEL_KERNELS_AVX2
+#endif
+#endif
+
+// CPU pixel passes shared by the cache builders (lights, blurs, fade masks,
+// sprite mips).
+//
+// Kernels work on interleaved 8-bit RGBA rows ("canonical" rows: bytes
+// r, g, b, a per pixel). unpack_row/pack_row convert from/to any packed
+// 32-bit SDL format once per row, replacing per-pixel SDL_GetRGBA/SDL_MapRGBA;
+// the common SDL formats get a conversion specialised at compile time.
+// SSE2/AVX2 paths are picked at runtime from SDL's CPU feature queries, with
+// scalar loops for the remainder and for other targets. Every path gives
+// bit-identical results.
+namespace PixelKernels {
+
+struct CpuFeatures {
+    bool sse2 = false;
+    bool avx2 = false;
+};
+
+inline const CpuFeatures& cpu() {
+    static const CpuFeatures features = [] {
+        CpuFeatures f;
+#ifdef PIXEL_KERNELS_X86
+        f.sse2 = SDL_HasSSE2() == SDL_TRUE;
+        f.avx2 = SDL_HasAVX2() == SDL_TRUE;
+#endif
+        return f;
+    }();
+    return features;
+}
+
+// Channel shifts of a packed 32-bit pixel with 8-bit channels.
+struct Layout {
+    int r = 0, g = 8, b = 16, a = 24;   // SDL_PIXELFORMAT_RGBA32 on little endian
+};
+
+// False for palettized, 16/24-bit or non-8-bit-channel formats.
+inline bool layout_of(const SDL_PixelFormat* fmt, Layout& out) {
+    if (!fmt || fmt->BytesPerPixel != 4) return false;
+    auto eight_bits = [](Uint32 mask, Uint8 shift) { return (mask >> shift) == 0xFFu; };
+    if (!eight_bits(fmt->Rmask, fmt->Rshift) || !eight_bits(fmt->Gmask, fmt->Gshift) ||
+        !eight_bits(fmt->Bmask, fmt->Bshift)) {
+        return false;
+    }
+    out.r = fmt->Rshift;
+    out.g = fmt->Gshift;
+    out.b = fmt->Bshift;
+    // No alpha channel: unpack reads the unused byte, so force it opaque on pack/unpack.
+    out.a = eight_bits(fmt->Amask, fmt->Ashift) ? fmt->Ashift : -1;
+    return true;
+}
+
+// True when packed pixels already are canonical rows in memory.
+inline bool is_canonical(const Layout& L) {
+    const Layout canonical;
+    return SDL_BYTEORDER == SDL_LIL_ENDIAN &&
+           L.r == canonical.r && L.g == canonical.g && L.b == canonical.b && L.a == canonical.a;
+}
+
+namespace detail {
+
+inline void unpack_scalar(const Uint32* src, Uint8* rgba, int n, const Layout& L) {
+    for (int i = 0; i < n; ++i) {
+        const Uint32 p = src[i];
+        rgba[i * 4 + 0] = Uint8(p >> L.r);
+        rgba[i * 4 + 1] = Uint8(p >> L.g);
+        rgba[i * 4 + 2] = Uint8(p >> L.b);
+        rgba[i * 4 + 3] = L.a >= 0 ? Uint8(p >> L.a) : 255;
+    }
+}
+
+inline void pack_scalar(const Uint8* rgba, Uint32* dst, int n, const Layout& L) {
+    for (int i = 0; i < n; ++i) {
+        Uint32 p = (Uint32(rgba[i * 4 + 0]) << L.r) |
+                   (Uint32(rgba[i * 4 + 1]) << L.g) |
+                   (Uint32(rgba[i * 4 + 2]) << L.b);
+        if (L.a >= 0) p |= Uint32(rgba[i * 4 + 3]) << L.a;
+        dst[i] = p;
+    }
+}
+
+inline bool byte_aligned(const Layout& L) {
+    return L.r % 8 == 0 && L.g % 8 == 0 && L.b % 8 == 0 && L.a >= 0 && L.a % 8 == 0;
+}
+
+#if defined(PIXEL_KERNELS_X86) && SDL_BYTEORDER == SDL_LIL_ENDIAN
+// With byte-aligned shifts every 32-bit layout is a byte permutation of the
+// canonical row, i.e. one pshufb per 8 pixels. to_canonical selects direction.
+PIXEL_KERNELS_AVX2
+inline int permute_avx2(const Uint8* src, Uint8* dst, int n, const Layout& L, bool to_canonical) {
+    const int shifts[4] = { L.r, L.g, L.b, L.a };
+    alignas(32) Uint8 mask[32];
+    for (int px = 0; px < 8; ++px) {
+        for (int c = 0; c < 4; ++c) {
+            const int packed_byte = shifts[c] / 8;
+            const int lane_px = px % 4;   // pshufb works within 128-bit lanes
+            if (to_canonical) mask[px * 4 + c] = Uint8(lane_px * 4 + packed_byte);
+            else              mask[px * 4 + packed_byte] = Uint8(lane_px * 4 + c);
+        }
+    }
+    const __m256i shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(v, shuffle));
+    }
+    return i;
+}
+
+// A packed format with its shifts known at compile time (A < 0: no alpha).
+// SSE2 has no byte shuffle, so channels move with shifts and masks, four
+// pixels at a time.
+template <int R, int G, int B, int A>
+struct PackedFormat {
+    static int unpack(const Uint32* src, Uint8* rgba, int n) {
+        const __m128i byte = _mm_set1_epi32(0xFF);
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i out = _mm_and_si128(_mm_srli_epi32(v, R), byte);
+            out = _mm_or_si128(out, _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, G), byte), 8));
+            out = _mm_or_si128(out, _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, B), byte), 16));
+            if constexpr (A >= 0) {
+                out = _mm_or_si128(out, _mm_slli_epi32(_mm_srli_epi32(v, A), 24));
+            } else {
+                out = _mm_or_si128(out, _mm_set1_epi32(int(0xFF000000u)));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), out);
+        }
+        return i;
+    }
+
+    static int pack(const Uint8* rgba, Uint32* dst, int n) {
+        const __m128i byte = _mm_set1_epi32(0xFF);
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 4));
+            __m128i out = _mm_slli_epi32(_mm_and_si128(v, byte), R);
+            out = _mm_or_si128(out, _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 8), byte), G));
+            out = _mm_or_si128(out, _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 16), byte), B));
+            if constexpr (A >= 0) {
+                out = _mm_or_si128(out, _mm_slli_epi32(_mm_srli_epi32(v, 24), A));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+        }
+        return i;
+    }
+};
+
+inline bool same_layout(const Layout& L, int r, int g, int b, int a) {
+    return L.r == r && L.g == g && L.b == b && L.a == a;
+}
+
+// Calls fn with the PackedFormat matching L among the usual SDL 32-bit
+// formats and returns its result, or 0 (nothing converted) for other layouts.
+template <typename Fn>
+inline int with_packed_format(const Layout& L, Fn&& fn) {
+    if (same_layout(L, 16, 8, 0, 24)) return fn(PackedFormat<16, 8, 0, 24>{});   // ARGB8888
+    if (same_layout(L, 24, 16, 8, 0)) return fn(PackedFormat<24, 16, 8, 0>{});   // RGBA8888
+    if (same_layout(L, 8, 16, 24, 0)) return fn(PackedFormat<8, 16, 24, 0>{});   // BGRA8888
+    if (same_layout(L, 16, 8, 0, -1)) return fn(PackedFormat<16, 8, 0, -1>{});   // RGB888
+    if (same_layout(L, 0, 8, 16, -1)) return fn(PackedFormat<0, 8, 16, -1>{});   // BGR888
+    return 0;
+}
+#endif
+
+} // namespace detail
+
+inline void unpack_row(const Uint32* src, Uint8* rgba, int n, const Layout& L) {
+    if (is_canonical(L)) {
+        std::memcpy(rgba, src, size_t(n) * 4);
+        return;
+    }
+    int done = 0;
+#if defined(PIXEL_KERNELS_X86) && SDL_BYTEORDER == SDL_LIL_ENDIAN
+    if (cpu().avx2 && detail::byte_aligned(L)) {
+        done = detail::permute_avx2(reinterpret_cast<const Uint8*>(src), rgba, n, L, true);
+    } else if (cpu().sse2) {
+        done = detail::with_packed_format(L, [&](auto format) { return decltype(format)::unpack(src, rgba, n); });
+    }
+#endif
+    detail::unpack_scalar(src + done, rgba + done * 4, n - done, L);
+}
+
+inline void pack_row(const Uint8* rgba, Uint32* dst, int n, const Layout& L) {
+    if (is_canonical(L)) {
+        std::memcpy(dst, rgba, size_t(n) * 4);
+        return;
+    }
+    int done = 0;
+#if defined(PIXEL_KERNELS_X86) && SDL_BYTEORDER == SDL_LIL_ENDIAN
+    if (cpu().avx2 && detail::byte_aligned(L)) {
+        done = detail::permute_avx2(rgba, reinterpret_cast<Uint8*>(dst), n, L, false);
+    } else if (cpu().sse2) {
+        done = detail::with_packed_format(L, [&](auto format) { return decltype(format)::pack(rgba, dst, n); });
+    }
+#endif
+    detail::pack_scalar(rgba + done * 4, dst + done, n - done, L);
+}
+
+// Whole-surface helpers. The surface must be unlocked or lockable and 32-bit;
+// returns false (leaving out untouched) otherwise.
+inline bool unpack_surface(SDL_Surface* surf, std::vector<Uint8>& out) {
+    Layout L;
+    if (!surf || !layout_of(surf->format, L)) return false;
+    if (SDL_MUSTLOCK(surf) && SDL_LockSurface(surf) != 0) return false;
+    out.resize(size_t(surf->w) * surf->h * 4);
+    for (int y = 0; y < surf->h; ++y) {
+        const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surf->pixels) + y * surf->pitch);
+        unpack_row(row, out.data() + size_t(y) * surf->w * 4, surf->w, L);
+    }
+    if (SDL_MUSTLOCK(surf)) SDL_UnlockSurface(surf);
+    return true;
+}
+
+inline bool pack_surface(const std::vector<Uint8>& rgba, SDL_Surface* surf) {
+    Layout L;
+    if (!surf || !layout_of(surf->format, L)) return false;
+    if (rgba.size() < size_t(surf->w) * surf->h * 4) return false;
+    if (SDL_MUSTLOCK(surf) && SDL_LockSurface(surf) != 0) return false;
+    for (int y = 0; y < surf->h; ++y) {
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surf->pixels) + y * surf->pitch);
+        pack_row(rgba.data() + size_t(y) * surf->w * 4, row, surf->w, L);
+    }
+    if (SDL_MUSTLOCK(surf)) SDL_UnlockSurface(surf);
+    return true;
+}
+
+namespace detail {
+
+#ifdef PIXEL_KERNELS_X86
+// One canonical pixel widened to four 32-bit lanes (r, g, b, a), and back
+// with saturation to 0..255.
+inline __m128i load_px(const Uint8* p) {
+    int bits;
+    std::memcpy(&bits, p, 4);
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+}
+
+inline void store_px(__m128i v, Uint8* p) {
+    const __m128i w = _mm_packs_epi32(v, v);
+    const int bits = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+    std::memcpy(p, &bits, 4);
+}
+
+// Low 32 bits of a * b per lane (SSE4.1 pmulld, built from pmuludq).
+inline __m128i mullo_epi32_sse2(__m128i a, __m128i b) {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+PIXEL_KERNELS_AVX2
+inline __m256i load8_avx2(const Uint8* p) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+
+PIXEL_KERNELS_AVX2
+inline void store8_avx2(__m256i v, Uint8* p) {
+    __m256i w = _mm256_packs_epi32(v, v);
+    w = _mm256_packus_epi16(w, w);
+    // Each 128-bit lane now holds its four bytes in its first dword.
+    w = _mm256_permutevar8x32_epi32(w, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(w));
+}
+#endif
+
+// Whole-row primitives of the vertical passes, which run down contiguous
+// rows of bytes and 32-bit sums. Each returns how many elements the vector
+// path handled; callers finish the rest with the scalar loop.
+#ifdef PIXEL_KERNELS_X86
+PIXEL_KERNELS_AVX2
+inline int add_bytes_avx2(const Uint32* base, const Uint8* in, Uint32* out, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(b, load8_avx2(in + i)));
+    }
+    return i;
+}
+
+inline int add_bytes_sse2(const Uint32* base, const Uint8* in, Uint32* out, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(b, load_px(in + i)));
+    }
+    return i;
+}
+
+PIXEL_KERNELS_AVX2
+inline int slide_bytes_avx2(Uint32* sums, const Uint8* add, const Uint8* sub, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + i));
+        s = _mm256_add_epi32(s, _mm256_sub_epi32(load8_avx2(add + i), load8_avx2(sub + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + i), s);
+    }
+    return i;
+}
+
+inline int slide_bytes_sse2(Uint32* sums, const Uint8* add, const Uint8* sub, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + i));
+        s = _mm_add_epi32(s, _mm_sub_epi32(load_px(add + i), load_px(sub + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i), s);
+    }
+    return i;
+}
+
+PIXEL_KERNELS_AVX2
+inline int scale_to_bytes_avx2(const Uint32* sums, Uint32 mul, Uint8* out, int n) {
+    const __m256i m = _mm256_set1_epi32(int(mul));
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + i));
+        store8_avx2(_mm256_srli_epi32(_mm256_mullo_epi32(s, m), 16), out + i);
+    }
+    return i;
+}
+
+inline int scale_to_bytes_sse2(const Uint32* sums, Uint32 mul, Uint8* out, int n) {
+    const __m128i m = _mm_set1_epi32(int(mul));
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + i));
+        store_px(_mm_srli_epi32(mullo_epi32_sse2(s, m), 16), out + i);
+    }
+    return i;
+}
+
+PIXEL_KERNELS_AVX2
+inline int madd_diff_avx2(Sint32* acc, Sint32 weight, const Uint32* hi, const Uint32* lo, int n) {
+    const __m256i w = _mm256_set1_epi32(weight);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i d = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi + i)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo + i)));
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        a = _mm256_add_epi32(a, _mm256_mullo_epi32(d, w));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), a);
+    }
+    return i;
+}
+
+inline int madd_diff_sse2(Sint32* acc, Sint32 weight, const Uint32* hi, const Uint32* lo, int n) {
+    const __m128i w = _mm_set1_epi32(weight);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i d = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi + i)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo + i)));
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+        a = _mm_add_epi32(a, mullo_epi32_sse2(d, w));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), a);
+    }
+    return i;
+}
+
+PIXEL_KERNELS_AVX2
+inline int round_to_bytes_avx2(const Sint32* acc, Uint8* out, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        store8_avx2(_mm256_srai_epi32(a, 16), out + i);
+    }
+    return i;
+}
+
+inline int round_to_bytes_sse2(const Sint32* acc, Uint8* out, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+        store_px(_mm_srai_epi32(a, 16), out + i);
+    }
+    return i;
+}
+#endif
+
+// out[i] = base[i] + in[i]; out may alias base.
+inline void add_bytes(const Uint32* base, const Uint8* in, Uint32* out, int n) {
+    int i = 0;
+#ifdef PIXEL_KERNELS_X86
+    if (cpu().avx2)      i = add_bytes_avx2(base, in, out, n);
+    else if (cpu().sse2) i = add_bytes_sse2(base, in, out, n);
+#endif
+    for (; i < n; ++i) out[i] = base[i] + in[i];
+}
+
+// sums[i] += add[i] - sub[i]
+inline void slide_bytes(Uint32* sums, const Uint8* add, const Uint8* sub, int n) {
+    int i = 0;
+#ifdef PIXEL_KERNELS_X86
+    if (cpu().avx2)      i = slide_bytes_avx2(sums, add, sub, n);
+    else if (cpu().sse2) i = slide_bytes_sse2(sums, add, sub, n);
+#endif
+    for (; i < n; ++i) sums[i] += Uint32(add[i]) - Uint32(sub[i]);
+}
+
+// out[i] = min(255, sums[i] * mul >> 16)
+inline void scale_to_bytes(const Uint32* sums, Uint32 mul, Uint8* out, int n) {
+    int i = 0;
+#ifdef PIXEL_KERNELS_X86
+    if (cpu().avx2)      i = scale_to_bytes_avx2(sums, mul, out, n);
+    else if (cpu().sse2) i = scale_to_bytes_sse2(sums, mul, out, n);
+#endif
+    for (; i < n; ++i) out[i] = Uint8(std::min<Uint32>(255, (sums[i] * mul) >> 16));
+}
+
+// acc[i] += weight * (hi[i] - lo[i])
+inline void madd_diff(Sint32* acc, Sint32 weight, const Uint32* hi, const Uint32* lo, int n) {
+    int i = 0;
+#ifdef PIXEL_KERNELS_X86
+    if (cpu().avx2)      i = madd_diff_avx2(acc, weight, hi, lo, n);
+    else if (cpu().sse2) i = madd_diff_sse2(acc, weight, hi, lo, n);
+#endif
+    for (; i < n; ++i) acc[i] += weight * Sint32(hi[i] - lo[i]);
+}
+
+// out[i] = clamp(acc[i] >> 16, 0, 255)
+inline void round_to_bytes(const Sint32* acc, Uint8* out, int n) {
+    int i = 0;
+#ifdef PIXEL_KERNELS_X86
+    if (cpu().avx2)      i = round_to_bytes_avx2(acc, out, n);
+    else if (cpu().sse2) i = round_to_bytes_sse2(acc, out, n);
+#endif
+    for (; i < n; ++i) out[i] = Uint8(std::clamp(acc[i] >> 16, 0, 255));
+}
+
+} // namespace detail
+
+// Separable box blur of a canonical RGBA image, clamped at the edges.
+// Sliding-window integer sums, O(1) per pixel regardless of radius.
+// Rows [y0, y1) of the horizontal pass / columns of the vertical pass can be
+// processed independently (see box_blur_h / box_blur_v) for threading.
+inline void box_blur_h(const Uint8* src, Uint8* dst, int w, int h, int radius, int y0, int y1) {
+    const int taps = radius * 2 + 1;
+    const Uint32 inv = (1u << 16) / Uint32(taps) + 1;   // fixed-point 1/taps
+    for (int y = std::max(0, y0); y < std::min(h, y1); ++y) {
+        const Uint8* in = src + size_t(y) * w * 4;
+        Uint8* out = dst + size_t(y) * w * 4;
+#ifdef PIXEL_KERNELS_X86
+        if (cpu().sse2) {
+            // All four channels slide together in one register.
+            __m128i sum = _mm_setzero_si128();
+            for (int k = -radius; k <= radius; ++k) sum = _mm_add_epi32(sum, detail::load_px(in + std::clamp(k, 0, w - 1) * 4));
+            const __m128i m = _mm_set1_epi32(int(inv));
+            for (int x = 0; x < w; ++x) {
+                detail::store_px(_mm_srli_epi32(detail::mullo_epi32_sse2(sum, m), 16), out + x * 4);
+                const int add = std::min(w - 1, x + radius + 1);
+                const int sub = std::max(0, x - radius);
+                sum = _mm_add_epi32(sum, _mm_sub_epi32(detail::load_px(in + add * 4), detail::load_px(in + sub * 4)));
+            }
+            continue;
+        }
+#endif
+        for (int c = 0; c < 4; ++c) {
+            Uint32 sum = 0;
+            for (int k = -radius; k <= radius; ++k) sum += in[std::clamp(k, 0, w - 1) * 4 + c];
+            for (int x = 0; x < w; ++x) {
+                out[x * 4 + c] = Uint8(std::min<Uint32>(255, (sum * inv) >> 16));
+                const int add = std::min(w - 1, x + radius + 1);
+                const int sub = std::max(0, x - radius);
+                sum += Uint32(in[add * 4 + c]) - Uint32(in[sub * 4 + c]);
+            }
+        }
+    }
+}
+
+// Vertical pass over rows [y0, y1); keeps whole-row running sums so every
+// step is a contiguous row operation.
+inline void box_blur_v(const Uint8* src, Uint8* dst, int w, int h, int radius, int y0, int y1) {
+    y0 = std::max(0, y0);
+    y1 = std::min(h, y1);
+    if (y0 >= y1) return;
+
+    const int taps = radius * 2 + 1;
+    const Uint32 inv = (1u << 16) / Uint32(taps) + 1;
+    const int row_bytes = w * 4;
+    std::vector<Uint32> sums(size_t(row_bytes), 0);
+
+    for (int k = y0 - radius; k <= y0 + radius; ++k) {
+        const Uint8* in = src + size_t(std::clamp(k, 0, h - 1)) * row_bytes;
+        detail::add_bytes(sums.data(), in, sums.data(), row_bytes);
+    }
+    for (int y = y0; y < y1; ++y) {
+        detail::scale_to_bytes(sums.data(), inv, dst + size_t(y) * row_bytes, row_bytes);
+
+        const Uint8* add = src + size_t(std::min(h - 1, y + radius + 1)) * row_bytes;
+        const Uint8* sub = src + size_t(std::max(0, y - radius)) * row_bytes;
+        detail::slide_bytes(sums.data(), add, sub, row_bytes);
+    }
+}
+
+// Half-size 2x2 box filter for mip chains; odd edges repeat the last pixel.
+// Colour is averaged weighted by alpha so transparent texels (whose rgb is
+// arbitrary) do not bleed dark fringes into sprite edges.
+inline void downsample_2x(const Uint8* src, int w, int h, std::vector<Uint8>& out, int& out_w, int& out_h) {
+    out_w = std::max(1, (w + 1) / 2);
+    out_h = std::max(1, (h + 1) / 2);
+    out.resize(size_t(out_w) * out_h * 4);
+#ifdef PIXEL_KERNELS_X86
+    const bool sse2 = cpu().sse2;
+#endif
+    for (int y = 0; y < out_h; ++y) {
+        const Uint8* r0 = src + size_t(std::min(h - 1, y * 2)) * w * 4;
+        const Uint8* r1 = src + size_t(std::min(h - 1, y * 2 + 1)) * w * 4;
+        Uint8* dst = &out[size_t(y) * out_w * 4];
+        for (int x = 0; x < out_w; ++x) {
+            const int x0 = std::min(w - 1, x * 2) * 4;
+            const int x1 = std::min(w - 1, x * 2 + 1) * 4;
+            const Uint8* px[4] = { r0 + x0, r0 + x1, r1 + x0, r1 + x1 };
+            const unsigned a_sum = unsigned(px[0][3]) + px[1][3] + px[2][3] + px[3][3];
+            Uint8* o = dst + x * 4;
+            if (a_sum == 0) {
+                for (int c = 0; c < 3; ++c) o[c] = Uint8((px[0][c] + px[1][c] + px[2][c] + px[3][c] + 2) / 4);
+                o[3] = 0;
+                continue;
+            }
+#ifdef PIXEL_KERNELS_X86
+            if (sse2) {
+                // Numerators stay below 2^24 and the divisor below 1024, so the
+                // float quotient truncates to the same integer as the division.
+                __m128i rgb = _mm_set1_epi32(int(a_sum / 2));
+                for (const Uint8* p : px) {
+                    rgb = _mm_add_epi32(rgb, detail::mullo_epi32_sse2(detail::load_px(p), _mm_set1_epi32(p[3])));
+                }
+                const __m128 q = _mm_div_ps(_mm_cvtepi32_ps(rgb), _mm_set1_ps(float(a_sum)));
+                detail::store_px(_mm_cvttps_epi32(q), o);
+                o[3] = Uint8((a_sum + 2) / 4);
+                continue;
+            }
+#endif
+            unsigned rgb[3] = { 0, 0, 0 };
+            for (const Uint8* p : px) {
+                for (int c = 0; c < 3; ++c) rgb[c] += unsigned(p[c]) * p[3];
+            }
+            for (int c = 0; c < 3; ++c) o[c] = Uint8((rgb[c] + a_sum / 2) / a_sum);
+            o[3] = Uint8((a_sum + 2) / 4);
+        }
+    }
+}
+
+// Symmetric kernel made of nested boxes: the weight of tap k is the sum of
+// weight over every step with radius >= |k|. Weights are 16.16 fixed point
+// and should sum to 1 << 16 over all taps; steps may carry negative weights
+// as long as every tap stays non-negative. Each step costs one prefix-sum
+// difference, so a pass is O(steps) per pixel regardless of radius.
+struct KernelStep {
+    int radius;
+    Sint32 weight;
+};
+
+inline int kernel_radius(const std::vector<KernelStep>& steps) {
+    int r = 0;
+    for (const auto& s : steps) r = std::max(r, s.radius);
+    return r;
+}
+
+// Horizontal pass of a stepped kernel over rows [y0, y1), clamped at the edges.
+inline void stepped_blur_h(const Uint8* src, Uint8* dst, int w, int h,
+                           const std::vector<KernelStep>& steps, int y0, int y1) {
+    const int R = kernel_radius(steps);
+    // Prefix sums of all four channels, interleaved like the pixels.
+    std::vector<Uint32> prefix(size_t(w + 2 * R + 1) * 4);
+    for (int y = std::max(0, y0); y < std::min(h, y1); ++y) {
+        const Uint8* in = src + size_t(y) * w * 4;
+        Uint8* out = dst + size_t(y) * w * 4;
+#ifdef PIXEL_KERNELS_X86
+        if (cpu().sse2) {
+            __m128i run = _mm_setzero_si128();
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(prefix.data()), run);
+            for (int e = 0; e < w + 2 * R; ++e) {
+                run = _mm_add_epi32(run, detail::load_px(in + std::clamp(e - R, 0, w - 1) * 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(&prefix[size_t(e + 1) * 4]), run);
+            }
+            for (int x = 0; x < w; ++x) {
+                const int e = x + R;
+                __m128i acc = _mm_set1_epi32(1 << 15);
+                for (const auto& s : steps) {
+                    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&prefix[size_t(e + s.radius + 1) * 4]));
+                    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&prefix[size_t(e - s.radius) * 4]));
+                    acc = _mm_add_epi32(acc, detail::mullo_epi32_sse2(_mm_sub_epi32(hi, lo), _mm_set1_epi32(s.weight)));
+                }
+                detail::store_px(_mm_srai_epi32(acc, 16), out + x * 4);
+            }
+            continue;
+        }
+#endif
+        for (int c = 0; c < 4; ++c) {
+            prefix[c] = 0;
+            for (int e = 0; e < w + 2 * R; ++e) {
+                prefix[size_t(e + 1) * 4 + c] = prefix[size_t(e) * 4 + c] + in[std::clamp(e - R, 0, w - 1) * 4 + c];
+            }
+            for (int x = 0; x < w; ++x) {
+                const int e = x + R;
+                Sint32 acc = 1 << 15;
+                for (const auto& s : steps) {
+                    acc += s.weight * Sint32(prefix[size_t(e + s.radius + 1) * 4 + c] - prefix[size_t(e - s.radius) * 4 + c]);
+                }
+                out[x * 4 + c] = Uint8(std::clamp(acc >> 16, 0, 255));
+            }
+        }
+    }
+}
+
+// Vertical pass over rows [y0, y1). Prefix sums run down whole rows so every
+// step is a contiguous row operation.
+inline void stepped_blur_v(const Uint8* src, Uint8* dst, int w, int h,
+                           const std::vector<KernelStep>& steps, int y0, int y1) {
+    y0 = std::max(0, y0);
+    y1 = std::min(h, y1);
+    if (y0 >= y1) return;
+
+    const int R = kernel_radius(steps);
+    const int row_bytes = w * 4;
+    const int first = y0 - R;
+    const int rows = (y1 - y0) + 2 * R;
+    std::vector<Uint32> prefix(size_t(rows + 1) * row_bytes, 0);
+    for (int r = 0; r < rows; ++r) {
+        const Uint8* in = src + size_t(std::clamp(first + r, 0, h - 1)) * row_bytes;
+        detail::add_bytes(&prefix[size_t(r) * row_bytes], in, &prefix[size_t(r + 1) * row_bytes], row_bytes);
+    }
+
+    std::vector<Sint32> acc(static_cast<size_t>(row_bytes));
+    for (int y = y0; y < y1; ++y) {
+        const int e = y - first;
+        std::fill(acc.begin(), acc.end(), 1 << 15);
+        for (const auto& s : steps) {
+            const Uint32* hi = &prefix[size_t(e + s.radius + 1) * row_bytes];
+            const Uint32* lo = &prefix[size_t(e - s.radius) * row_bytes];
+            detail::madd_diff(acc.data(), s.weight, hi, lo, row_bytes);
+        }
+        detail::round_to_bytes(acc.data(), dst + size_t(y) * row_bytes, row_bytes);
+    }
+}
+
+// Summed-area table, (w + 1) * (h + 1) entries of 4 channels each. Entries may
+// wrap on large images; box sums stay exact as long as one box fits in 32 bits.
+struct SummedAreaTable {
+    // Largest box mean() divides in float: up to here (s + 0.5) / area in
+    // single precision truncates to the exact integer quotient.
+    static constexpr int FLOAT_MEAN_MAX_AREA = 4096;
+
+    int w = 0, h = 0;
+    std::vector<Uint32> sums;
+
+    void build(const Uint8* rgba, int width, int height) {
+        w = width;
+        h = height;
+        sums.assign(size_t(w + 1) * (h + 1) * 4, 0);
+        const size_t stride = size_t(w + 1) * 4;
+        for (int y = 1; y <= h; ++y) {
+            const Uint8* in = rgba + size_t(y - 1) * w * 4;
+            Uint32* cur = sums.data() + y * stride;
+            const Uint32* up = cur - stride;
+#ifdef PIXEL_KERNELS_X86
+            if (cpu().sse2) {
+                __m128i row = _mm_setzero_si128();
+                for (int x = 1; x <= w; ++x) {
+                    row = _mm_add_epi32(row, detail::load_px(in + (x - 1) * 4));
+                    const __m128i above = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + x * 4));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(cur + x * 4), _mm_add_epi32(above, row));
+                }
+                continue;
+            }
+#endif
+            Uint32 row[4] = { 0, 0, 0, 0 };
+            for (int x = 1; x <= w; ++x) {
+                for (int c = 0; c < 4; ++c) {
+                    row[c] += in[(x - 1) * 4 + c];
+                    cur[x * 4 + c] = up[x * 4 + c] + row[c];
+                }
+            }
+        }
+    }
+
+    // Mean of the box [x0, x1) x [y0, y1), already clipped to the image.
+    void mean(int x0, int y0, int x1, int y1, Uint8* out) const {
+        const size_t stride = size_t(w + 1) * 4;
+        const Uint32* a = sums.data() + y0 * stride;
+        const Uint32* b = sums.data() + y1 * stride;
+        const int area = std::max(1, (x1 - x0) * (y1 - y0));
+#ifdef PIXEL_KERNELS_X86
+        if (area <= FLOAT_MEAN_MAX_AREA && cpu().sse2) {
+            auto at = [](const Uint32* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+            const __m128i s = _mm_sub_epi32(_mm_add_epi32(at(b + x1 * 4), at(a + x0 * 4)),
+                                            _mm_add_epi32(at(b + x0 * 4), at(a + x1 * 4)));
+            const __m128 q = _mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(s), _mm_set1_ps(0.5f)),
+                                        _mm_set1_ps(1.0f / float(area)));
+            detail::store_px(_mm_cvttps_epi32(q), out);
+            return;
+        }
+#endif
+        for (int c = 0; c < 4; ++c) {
+            const Uint32 s = b[x1 * 4 + c] - b[x0 * 4 + c] - a[x1 * 4 + c] + a[x0 * 4 + c];
+            out[c] = Uint8(s / Uint32(area));
+        }
+    }
+};
+
+// Box blur through a summed-area table: exact clipped-window average, like
+// the original blurSurfaceFast.
+inline void sat_box_blur(std::vector<Uint8>& rgba, int w, int h, int radius) {
+    if (radius <= 0 || w <= 0 || h <= 0) return;
+    SummedAreaTable sat;
+    sat.build(rgba.data(), w, h);
+    for (int y = 0; y < h; ++y) {
+        const int y0 = std::max(0, y - radius), y1 = std::min(h, y + radius + 1);
+        for (int x = 0; x < w; ++x) {
+            const int x0 = std::max(0, x - radius), x1 = std::min(w, x + radius + 1);
+            sat.mean(x0, y0, x1, y1, rgba.data() + (size_t(y) * w + x) * 4);
+        }
+    }
+}
+
+} // namespace PixelKernels
@@ -0,0 +1,110 @@
+// === File: regen_scheduler.cpp ===
+#include "regen_scheduler.hpp"
+#include "render_asset.hpp"
+#include "lit_texture_cache.hpp"
+#include "Asset.hpp"
+#include <algorithm>
+#include <cmath>
+
+static constexpr float SIZE_WEIGHT     = 1.0f;   // per 256 px of sqrt(screen area)
+static constexpr float DISTANCE_WEIGHT = 1.5f;   // per 1000 px from the player
+static constexpr float STALE_WEIGHT    = 0.25f;  // per frame spent stale
+static constexpr float MISSING_BONUS   = 1.0e6f; // nothing to draw yet
+
+RegenScheduler::RegenScheduler(int budget_us)
+    : budget_us_(budget_us) {}
+
+void RegenScheduler::begin_frame() {
+    ++frame_;
+    queue_ = {};
+    prefetch_.clear();
+
+    // Forget assets that were not requested last frame (regenerated elsewhere,
+    // deactivated, or no longer stale).
+    for (auto it = stale_.begin(); it != stale_.end();) {
+        if (it->second.last_seen < frame_ - 1) it = stale_.erase(it);
+        else ++it;
+    }
+}
+
+void RegenScheduler::request(Asset* a,
+                             std::uint64_t key,
+                             const SDL_Rect& screen_rect,
+                             int player_x,
+                             int player_y)
+{
+    if (!a) return;
+
+    auto [it, inserted] = stale_.try_emplace(a, StaleInfo{ frame_, frame_ });
+    it->second.last_seen = frame_;
+    const int stale_frames = frame_ - it->second.since;
+
+    const float size = std::sqrt(float(screen_rect.w) * float(screen_rect.h)) / 256.0f;
+    const float dx = float(a->pos_X - player_x);
+    const float dy = float(a->pos_Y - player_y);
+    const float dist = std::sqrt(dx * dx + dy * dy) / 1000.0f;
+
+    float priority = size * SIZE_WEIGHT - dist * DISTANCE_WEIGHT + stale_frames * STALE_WEIGHT;
+    if (!a->get_final_texture()) priority += MISSING_BONUS;
+
+    queue_.push({ priority, a, key });
+}
+
+void RegenScheduler::prefetch(Asset* a, std::uint64_t key, int lighting_state) {
+    if (!a || lighting_state < 0) return;
+    prefetch_.push_back({ a, key, lighting_state });
+}
+
+int RegenScheduler::run(RenderAsset& render_asset, LitTextureCache& cache) {
+    const double ticks_per_us = double(SDL_GetPerformanceFrequency()) / 1.0e6;
+    const Uint64 start = SDL_GetPerformanceCounter();
+    const int state = render_asset.get_lighting_state();
+    int done = 0;
+
+    while (!queue_.empty()) {
+        const double elapsed_us = double(SDL_GetPerformanceCounter() - start) / ticks_per_us;
+        // Always make progress on at least one job, then stop before the next
+        // expected regen would overrun the budget.
+        if (done > 0 && elapsed_us + avg_cost_us_ > budget_us_) break;
+
+        Job job = queue_.top();
+        queue_.pop();
+
+        // Another instance with the same key may have been baked earlier this frame.
+        if (auto shared = cache.find(job.key)) {
+            job.asset->set_final_texture(std::move(shared), job.key, state);
+            stale_.erase(job.asset);
+            continue;
+        }
+
+        const Uint64 t0 = SDL_GetPerformanceCounter();
+        SDL_Texture* tex = render_asset.regenerateFinalTexture(job.asset);
+        job.asset->set_final_texture(cache.insert(job.key, tex), job.key, state);
+        const double cost_us = double(SDL_GetPerformanceCounter() - t0) / ticks_per_us;
+
+        avg_cost_us_ = (avg_cost_us_ == 0.0) ? cost_us : avg_cost_us_ * 0.9 + cost_us * 0.1;
+        stale_.erase(job.asset);
+        ++done;
+    }
+
+    for (const Prefetch& job : prefetch_) {
+        if (!queue_.empty()) break;   // stale assets came first and used the budget
+        const double elapsed_us = double(SDL_GetPerformanceCounter() - start) / ticks_per_us;
+        if (elapsed_us + avg_cost_us_ > budget_us_) break;
+
+        if (auto shared = cache.find(job.key)) {
+            job.asset->set_state_variant(std::move(shared), job.key);
+            continue;
+        }
+
+        const Uint64 t0 = SDL_GetPerformanceCounter();
+        SDL_Texture* tex = render_asset.regenerateFinalTexture(job.asset, job.lighting_state);
+        job.asset->set_state_variant(cache.insert(job.key, tex), job.key);
+        const double cost_us = double(SDL_GetPerformanceCounter() - t0) / ticks_per_us;
+        avg_cost_us_ = (avg_cost_us_ == 0.0) ? cost_us : avg_cost_us_ * 0.9 + cost_us * 0.1;
+    }
+
+    queue_ = {};
+    prefetch_.clear();
+    return done;
+}
@@ -0,0 +1,68 @@
+// === File: regen_scheduler.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+class Asset;
+class RenderAsset;
+class LitTextureCache;
+
+// Spreads final-texture regeneration over frames. Stale assets are queued by
+// priority (screen size, distance to the player, frames spent stale) and
+// regenerated until the per-frame time budget is used up; the rest keep
+// drawing their previous final texture.
+class RegenScheduler {
+public:
+    explicit RegenScheduler(int budget_us = 4000);
+
+    void begin_frame();
+
+    void request(Asset* a,
+                 std::uint64_t key,
+                 const SDL_Rect& screen_rect,
+                 int player_x,
+                 int player_y);
+
+    // Bakes the variant for an upcoming lighting state with whatever budget
+    // the stale assets leave over this frame (never forced).
+    void prefetch(Asset* a, std::uint64_t key, int lighting_state);
+
+    // Bakes are published to / reused from cache. Returns the number of
+    // textures regenerated this frame.
+    int run(RenderAsset& render_asset, LitTextureCache& cache);
+
+    void set_budget_us(int budget_us) { budget_us_ = budget_us; }
+    int  get_budget_us() const { return budget_us_; }
+    double get_avg_cost_us() const { return avg_cost_us_; }
+
+private:
+    struct Job {
+        float priority;
+        Asset* asset;
+        std::uint64_t key;
+        bool operator<(const Job& o) const { return priority < o.priority; }
+    };
+
+    int budget_us_;
+    int frame_ = 0;
+    double avg_cost_us_ = 0.0;
+
+    struct StaleInfo {
+        int since;
+        int last_seen;
+    };
+
+    struct Prefetch {
+        Asset* asset;
+        std::uint64_t key;
+        int lighting_state;
+    };
+
+    std::priority_queue<Job> queue_;
+    std::vector<Prefetch> prefetch_;
+    std::unordered_map<Asset*, StaleInfo> stale_;
+};
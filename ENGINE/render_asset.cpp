@@ -5,9 +5,9 @@
 #include "Asset.hpp"
 #include "assets.hpp"
 #include "light_utils.hpp" 
+#include "shadow_overlay.hpp"
 #include <algorithm>
 #include <cmath>
-#include <random>
 #include <iostream>
 
 RenderAsset::RenderAsset(SDL_Renderer* renderer,
@@ -29,40 +29,152 @@ SDL_Texture* RenderAsset::render_shadow_mask(Asset* a, int bw, int bh) {
     SDL_SetTextureBlendMode(mask, SDL_BLENDMODE_BLEND);
     SDL_Texture* prev_target = SDL_GetRenderTarget(renderer_);
     SDL_SetRenderTarget(renderer_, mask);
-    SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 0);
-    SDL_RenderClear(renderer_);
 
-    if (SDL_Texture* base = a->get_current_frame()) {
-        SDL_SetTextureBlendMode(base, SDL_BLENDMODE_BLEND);
-        SDL_SetTextureColorMod(base, 0, 0, 0);
-        SDL_RenderCopy(renderer_, base, nullptr, nullptr);
-        SDL_SetTextureColorMod(base, 255, 255, 255);
+    if (SDL_Texture* silhouette = a->get_current_silhouette()) {
+        SDL_RenderCopy(renderer_, silhouette, nullptr, nullptr);
+    } else {
+        SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 0);
+        SDL_RenderClear(renderer_);
+        if (SDL_Texture* base = a->get_current_frame()) {
+            SDL_SetTextureBlendMode(base, SDL_BLENDMODE_BLEND);
+            SDL_SetTextureColorMod(base, 0, 0, 0);
+            SDL_RenderCopy(renderer_, base, nullptr, nullptr);
+            SDL_SetTextureColorMod(base, 255, 255, 255);
+        }
     }
 
     SDL_Point parallax_pos = util_.applyParallax(a->pos_X, a->pos_Y);
     SDL_Rect bounds{ parallax_pos.x - bw / 2, parallax_pos.y - bh, bw, bh };
-    const Uint8 light_alpha = static_cast<Uint8>(main_light_source_.get_brightness());
+    const Global_Light_Source::LightingState lighting = bake_lighting();
+    const Uint8 light_alpha = static_cast<Uint8>(lighting.brightness);
 
     render_shadow_received_static_lights(a, bounds, light_alpha);
     render_shadow_moving_lights(a, bounds, light_alpha);
 
-    const Uint8 main_alpha = main_light_source_.get_current_color().a;
-    render_shadow_orbital_lights(a, bounds, main_alpha);
+    if (a->info) render_shadow_orbital_lights(*a->info, a->pos_X, a->pos_Y, bounds, lighting.color.a);
+
+    SDL_SetRenderTarget(renderer_, prev_target);
+    return mask;
+}
+
+Global_Light_Source::LightingState RenderAsset::bake_lighting() const {
+    if (bake_state_ >= 0) return main_light_source_.get_lighting_state(bake_state_);
+    return { main_light_source_.get_current_color(),
+             main_light_source_.get_tint(),
+             main_light_source_.get_brightness() };
+}
+
+SDL_Color RenderAsset::base_tint(const Asset* a, bool blended) const {
+    return tint_for(a->alpha_percentage, a->info->type == "Player", blended);
+}
+
+SDL_Color RenderAsset::tint_for(double factor, bool player, bool blended) const {
+    const Global_Light_Source::LightingState lighting = bake_lighting();
+    const Uint8 main_alpha = blended ? main_light_source_.get_blended_color().a
+                                     : lighting.color.a;
+    const float c = static_cast<float>(factor);
+    int alpha_mod = (c >= 1.0f) ? 255 : int(main_alpha * c);
+    if (player) alpha_mod = std::min(255, alpha_mod * 3);
+
+    const SDL_Color white{255, 255, 255, 255};
+    return blended ? main_light_source_.apply_blended_tint_to_color(white, alpha_mod)
+                   : main_light_source_.apply_tint_to_color(white, alpha_mod, lighting.tint);
+}
+
+int RenderAsset::get_lighting_state() const {
+    return main_light_source_.get_state_index();
+}
+
+static bool wants_gradient_shadow(const Asset* a) {
+    return a->gradient_shadow && a->info->has_gradient_shadow &&
+           a->info->gradient_shadow_intensity > 0 && a->info->number_of_gradient_shadows > 0;
+}
+
+bool RenderAsset::is_uniformly_lit(const Asset* a) const {
+    if (!a || !a->info) return false;
+    if (wants_gradient_shadow(a)) return false;
+    if (!a->has_shading) return true;
+    return a->static_lights.empty() &&
+           a->info->orbital_light_sources.empty() &&
+           !a->get_render_player_light();
+}
+
+SDL_Color RenderAsset::uniform_color_mod(const Asset* a) const {
+    // A shaded asset with no light reaching it is fully masked by its silhouette.
+    if (a->has_shading) return { 0, 0, 0, 255 };
+    // Drawn every frame, so it can follow the day/night crossfade directly.
+    return base_tint(a, true);
+}
+
+SDL_Color RenderAsset::ambient_color_mod(const Asset* a) const {
+    return base_tint(a, true);
+}
+
+SDL_Color RenderAsset::ambient_tint() const {
+    return main_light_source_.apply_blended_tint_to_color(SDL_Color{255, 255, 255, 255}, 255);
+}
+
+SDL_Color RenderAsset::merged_color_mod(const MergedSprite& s) const {
+    // Tiles are baked once per lighting state, so they take the settled tint.
+    return tint_for(s.tint_factor, false, false);
+}
+
+SDL_Texture* RenderAsset::merged_shading_mask(const MergedSprite& s) {
+    if (!s.shaded || !s.frame || !s.info || s.w <= 0 || s.h <= 0) return nullptr;
 
-    SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_MOD);
-    SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 204);
-    SDL_RenderFillRect(renderer_, nullptr);
+    SDL_Texture* mask = SDL_CreateTexture(renderer_,
+                                          SDL_PIXELFORMAT_RGBA8888,
+                                          SDL_TEXTUREACCESS_TARGET,
+                                          s.w, s.h);
+    if (!mask) return nullptr;
+
+    SDL_SetTextureBlendMode(mask, SDL_BLENDMODE_BLEND);
+    SDL_Texture* prev_target = SDL_GetRenderTarget(renderer_);
+    SDL_SetRenderTarget(renderer_, mask);
+
+    if (s.silhouette) {
+        SDL_RenderCopy(renderer_, s.silhouette, nullptr, nullptr);
+    } else {
+        SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 0);
+        SDL_RenderClear(renderer_);
+        SDL_SetTextureBlendMode(s.frame, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureColorMod(s.frame, 0, 0, 0);
+        SDL_RenderCopy(renderer_, s.frame, nullptr, nullptr);
+        SDL_SetTextureColorMod(s.frame, 255, 255, 255);
+    }
+
+    // Parallax is affine, so lights land where they would on the live sprite.
+    // Static and player lights do not reach the far boundary tiles come from.
+    SDL_Point parallax_pos = util_.applyParallax(s.x, s.y);
+    SDL_Rect bounds{ parallax_pos.x - s.w / 2, parallax_pos.y - s.h, s.w, s.h };
+    render_shadow_orbital_lights(*s.info, s.x, s.y, bounds, bake_lighting().color.a);
 
     SDL_SetRenderTarget(renderer_, prev_target);
+    SDL_SetTextureBlendMode(mask, SDL_BLENDMODE_MOD);
     return mask;
 }
 
-SDL_Texture* RenderAsset::regenerateFinalTexture(Asset* a) {
+bool RenderAsset::has_time_of_day_variants(const Asset* a) const {
+    if (!a || !a->info || a == p || !a->static_frame) return false;
+    if (!a->info->orbital_light_sources.empty() || a->get_render_player_light()) return false;
+    for (const auto& sl : a->static_lights) {
+        if (sl.source && sl.source->flicker > 0) return false;
+    }
+    return true;
+}
+
+SDL_Texture* RenderAsset::regenerateFinalTexture(Asset* a, int lighting_state) {
+    bake_state_ = lighting_state;
+    SDL_Texture* tex = bake_final_texture(a);
+    bake_state_ = -1;
+    return tex;
+}
+
+SDL_Texture* RenderAsset::bake_final_texture(Asset* a) {
     if (!a) return nullptr;
     SDL_Texture* base = a->get_current_frame();
     if (!base) return nullptr;
 
-    const Uint8 main_alpha = main_light_source_.get_current_color().a;
     int bw = a->cached_w, bh = a->cached_h;
     if (bw == 0 || bh == 0) SDL_QueryTexture(base, nullptr, nullptr, &bw, &bh);
 
@@ -78,16 +190,22 @@ SDL_Texture* RenderAsset::regenerateFinalTexture(Asset* a) {
     SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
     SDL_RenderClear(renderer_);
 
-    const float c = a->alpha_percentage;
-    int alpha_mod = (c >= 1.0f) ? 255 : int(main_alpha * c);
-    if (a->info->type == "Player") alpha_mod = std::min(255, alpha_mod * 3);
-
-    const SDL_Color mod_color = main_light_source_.apply_tint_to_color({255, 255, 255, 255}, alpha_mod);
+    const SDL_Color mod_color = base_tint(a);
 
     SDL_SetTextureColorMod(base, mod_color.r, mod_color.g, mod_color.b);
     SDL_RenderCopy(renderer_, base, nullptr, nullptr);
     SDL_SetTextureColorMod(base, 255, 255, 255);
 
+    if (wants_gradient_shadow(a)) {
+        // Darkens towards the bottom of the sprite; each extra gradient stacks.
+        ShadowOverlay overlay(renderer_);
+        overlay.set_intensity(a->info->gradient_shadow_intensity * 255 / 100);
+        const SDL_Rect full{ 0, 0, bw, bh };
+        for (int i = 0; i < a->info->number_of_gradient_shadows; ++i) {
+            overlay.render_gradient(base, full);
+        }
+    }
+
     if (a->has_shading) {
         if (SDL_Texture* mask = render_shadow_mask(a, bw, bh)) {
             SDL_SetRenderTarget(renderer_, final_tex);
@@ -133,16 +251,15 @@ void RenderAsset::render_shadow_moving_lights(Asset* a, const SDL_Rect& bounds,
     }
 }
 
-void RenderAsset::render_shadow_orbital_lights(Asset* a, const SDL_Rect& bounds, Uint8 alpha) {
-    if (!a || !a->info) return;
-
+void RenderAsset::render_shadow_orbital_lights(const AssetInfo& info, int x, int y,
+                                               const SDL_Rect& bounds, Uint8 alpha) {
     const float angle = main_light_source_.get_angle();
 
-    for (const auto& light : a->info->orbital_light_sources) {
+    for (const auto& light : info.orbital_light_sources) {
         if (!light.texture || light.x_radius <= 0 || light.y_radius <= 0) continue;
 
-        const float lx = a->pos_X + std::cos(angle) * light.x_radius;
-        const float ly = a->pos_Y - std::sin(angle) * light.y_radius;
+        const float lx = x + std::cos(angle) * light.x_radius;
+        const float ly = y - std::sin(angle) * light.y_radius;
 
         SDL_Point pnt = util_.applyParallax(static_cast<int>(std::round(lx)),
                                             static_cast<int>(std::round(ly)));
@@ -162,33 +279,99 @@ void RenderAsset::render_shadow_orbital_lights(Asset* a, const SDL_Rect& bounds,
     }
 }
 
-void RenderAsset::render_shadow_received_static_lights(Asset* a, const SDL_Rect& bounds, Uint8 alpha) {
-    if (!a) return;
-    static std::mt19937 flicker_rng{ std::random_device{}() };
+static SDL_Rect static_light_rect(const RenderUtils& util,
+                                  const Asset* a,
+                                  const StaticLight& sl,
+                                  const SDL_Rect& bounds) {
+    SDL_Point pnt = util.applyParallax(a->pos_X + sl.offset_x, a->pos_Y + sl.offset_y);
+
+    int lw = sl.source->cached_w, lh = sl.source->cached_h;
+    if (lw == 0 || lh == 0) SDL_QueryTexture(sl.source->texture, nullptr, nullptr, &lw, &lh);
+
+    return SDL_Rect{
+        pnt.x - lw / 2 - bounds.x,
+        pnt.y - lh / 2 - bounds.y,
+        lw, lh
+    };
+}
+
+// Steady static lights never change relative to their asset, so they are
+// summed once into a half-resolution mask (opaque black + ADDed lights) and
+// reused by every regen until the frame size or brightness changes or the
+// asset deactivates. Brightness is applied per light before the sum
+// saturates, as when each light was ADDed to the bake on its own.
+SDL_Texture* RenderAsset::get_static_light_mask(Asset* a, const SDL_Rect& bounds, Uint8 alpha) {
+    if (a->static_light_mask &&
+        a->static_light_mask_w == bounds.w &&
+        a->static_light_mask_h == bounds.h &&
+        a->static_light_mask_alpha == alpha) {
+        return a->static_light_mask.get();
+    }
+    a->static_light_mask.reset();
 
+    bool any_steady = false;
     for (const auto& sl : a->static_lights) {
-        if (!sl.source || !sl.source->texture) continue;
+        if (sl.source && sl.source->texture && sl.source->flicker <= 0) {
+            any_steady = true;
+            break;
+        }
+    }
+    if (!any_steady) return nullptr;
 
-        SDL_Point pnt = util_.applyParallax(a->pos_X + sl.offset_x, a->pos_Y + sl.offset_y);
+    const int mw = std::max(1, (bounds.w + 1) / 2);
+    const int mh = std::max(1, (bounds.h + 1) / 2);
+    SDL_Texture* mask = SDL_CreateTexture(renderer_,
+                                          SDL_PIXELFORMAT_RGBA8888,
+                                          SDL_TEXTUREACCESS_TARGET,
+                                          mw, mh);
+    if (!mask) return nullptr;
+    SDL_SetTextureScaleMode(mask, SDL_ScaleModeLinear);
 
-        int lw = sl.source->cached_w, lh = sl.source->cached_h;
-        if (lw == 0 || lh == 0) SDL_QueryTexture(sl.source->texture, nullptr, nullptr, &lw, &lh);
+    SDL_Texture* prev_target = SDL_GetRenderTarget(renderer_);
+    SDL_SetRenderTarget(renderer_, mask);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
+    SDL_RenderClear(renderer_);
 
-        SDL_Rect dst {
-            pnt.x - lw / 2 - bounds.x,
-            pnt.y - lh / 2 - bounds.y,
-            lw, lh
-        };
+    for (const auto& sl : a->static_lights) {
+        if (!sl.source || !sl.source->texture || sl.source->flicker > 0) continue;
+
+        SDL_Rect dst = static_light_rect(util_, a, sl, bounds);
+        dst.x /= 2; dst.y /= 2;
+        dst.w = std::max(1, dst.w / 2);
+        dst.h = std::max(1, dst.h / 2);
+
+        const float light_alpha = static_cast<float>(alpha) * static_cast<float>(sl.alpha_percentage);
+        SDL_SetTextureBlendMode(sl.source->texture, SDL_BLENDMODE_ADD);
+        SDL_SetTextureAlphaMod(sl.source->texture, static_cast<Uint8>(std::clamp(light_alpha, 0.0f, 255.0f)));
+        SDL_RenderCopy(renderer_, sl.source->texture, nullptr, &dst);
+    }
+
+    SDL_SetRenderTarget(renderer_, prev_target);
+
+    SDL_SetTextureBlendMode(mask, SDL_BLENDMODE_ADD);
+    a->static_light_mask.reset(mask, SDL_DestroyTexture);
+    a->static_light_mask_w = bounds.w;
+    a->static_light_mask_h = bounds.h;
+    a->static_light_mask_alpha = alpha;
+    return mask;
+}
+
+void RenderAsset::render_shadow_received_static_lights(Asset* a, const SDL_Rect& bounds, Uint8 alpha) {
+    if (!a || a->static_lights.empty()) return;
+
+    SDL_Texture* steady = get_static_light_mask(a, bounds, alpha);
+    if (steady) SDL_RenderCopy(renderer_, steady, nullptr, nullptr);
+
+    for (const auto& sl : a->static_lights) {
+        if (!sl.source || !sl.source->texture) continue;
+        if (steady && sl.source->flicker <= 0) continue;
+
+        SDL_Rect dst = static_light_rect(util_, a, sl, bounds);
 
         SDL_SetTextureBlendMode(sl.source->texture, SDL_BLENDMODE_ADD);
 
         float base_alpha = static_cast<float>(alpha) * sl.alpha_percentage;
-        if (sl.source->flicker > 0) {
-            const float brightness_scale = std::clamp(sl.source->intensity / 255.0f, 0.0f, 1.0f);
-            const float max_jitter = (sl.source->flicker / 100.0f) * brightness_scale;
-            std::uniform_real_distribution<float> dist(-max_jitter, max_jitter);
-            base_alpha *= (1.0f + dist(flicker_rng));
-        }
+        base_alpha *= LightUtils::flicker_scale(*sl.source, flicker_phase_, sl.owner);
 
         SDL_SetTextureAlphaMod(sl.source->texture, static_cast<Uint8>(std::clamp(base_alpha, 0.0f, 255.0f)));
         SDL_RenderCopy(renderer_, sl.source->texture, nullptr, &dst);
@@ -3,10 +3,13 @@
 
 #include <SDL.h>
 #include <string>
+#include <cstdint>
+#include "global_light_source.hpp"
 
 class Asset;
+class AssetInfo;
+struct MergedSprite;
 class RenderUtils;
-class Global_Light_Source;
 
 class RenderAsset {
 public:
@@ -16,17 +19,54 @@ public:
 
     // Creates/loads a single combined texture for an asset (base sprite + lighting/shadows).
     // Returns a newly created texture owned by the caller (caller should assign into Asset).
-    SDL_Texture* regenerateFinalTexture(Asset* a);
+    // lighting_state bakes for that Global_Light_Source state instead of the current one.
+    SDL_Texture* regenerateFinalTexture(Asset* a, int lighting_state = -1);
+
+    // Bake depends only on the lighting state (single frame, steady static
+    // lights only), so the next state's variant can be baked ahead of time.
+    bool has_time_of_day_variants(const Asset* a) const;
+
+    // True when no per-pixel light reaches the asset, so its final texture would
+    // only be the current frame with a uniform tint.
+    bool is_uniformly_lit(const Asset* a) const;
+    // Color mod reproducing that tint; lets the frame be drawn without a bake.
+    SDL_Color uniform_color_mod(const Asset* a) const;
+    // Ambient tint alone, ignoring shading (for far views where lights are
+    // left to the light map).
+    SDL_Color ambient_color_mod(const Asset* a) const;
+    // The same for a fully opaque asset.
+    SDL_Color ambient_tint() const;
+    // Settled ambient tint of the current lighting state for a sprite merged
+    // into a distant tile (see MergedSprite::tint_factor).
+    SDL_Color merged_color_mod(const MergedSprite& s) const;
+    // Shading a merged sprite's frame is multiplied by (MOD blended), as its
+    // final texture would be: silhouette plus orbital lights. nullptr if the
+    // sprite is not shaded. The result depends only on the frame and the
+    // lighting, not on where the sprite stands. Caller owns it.
+    SDL_Texture* merged_shading_mask(const MergedSprite& s);
+
+    // Lighting state bakes are made for (Global_Light_Source::get_state_index).
+    int get_lighting_state() const;
+
+    // Flicker phase used for received static lights (see LightUtils::flicker_scale).
+    void set_flicker_phase(std::uint32_t phase) { flicker_phase_ = phase; }
 
 private:
     Asset* p;
+    SDL_Color base_tint(const Asset* a, bool blended = false) const;
+    SDL_Color tint_for(double factor, bool player, bool blended) const;
+    Global_Light_Source::LightingState bake_lighting() const;
+    SDL_Texture* bake_final_texture(Asset* a);
     SDL_Texture* render_shadow_mask(Asset* a, int bw, int bh);
     void render_shadow_moving_lights(Asset* a, const SDL_Rect& bounds, Uint8 alpha);
-    void render_shadow_orbital_lights(Asset* a, const SDL_Rect& bounds, Uint8 alpha);
+    void render_shadow_orbital_lights(const AssetInfo& info, int x, int y, const SDL_Rect& bounds, Uint8 alpha);
     void render_shadow_received_static_lights(Asset* a, const SDL_Rect& bounds, Uint8 alpha);
+    SDL_Texture* get_static_light_mask(Asset* a, const SDL_Rect& bounds, Uint8 alpha);
 
 private:
     SDL_Renderer* renderer_;
     RenderUtils& util_;
     Global_Light_Source& main_light_source_;
+    std::uint32_t flicker_phase_ = 0;
+    int bake_state_ = -1;   // set for the duration of regenerateFinalTexture
 };
@@ -3,17 +3,61 @@
 #include "Asset.hpp"
 #include "render_utils.hpp"
 #include "light_map.hpp"
+#include "light_utils.hpp"
+#include "hash_utils.hpp"
 
 #include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <random>
 #include <tuple>
+#include <unordered_set>
 #include <vector>
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 static constexpr SDL_Color SLATE_COLOR = {69, 101, 74, 255};
 static constexpr float MIN_VISIBLE_SCREEN_RATIO = 0.025f;
 
+// Quantization of the regen key inputs. Changes smaller than one step reuse the
+// existing final texture. Color, tint and brightness are already quantized into
+// Global_Light_Source lighting states.
+static constexpr float ANGLE_BUCKETS       = 180;  // 2 degrees per bucket
+static constexpr int   PLAYER_LIGHT_BUCKET = 8;    // px
+static constexpr float LIGHT_FACTOR_STEPS  = 32;
+
+static constexpr int REGEN_BUDGET_US = 4000;
+// Crossfade from a texture baked for the previous lighting state, at the pace
+// of the global crossfade that uniform sprites and the light map follow.
+static constexpr float STATE_FADE_STEP = 1.0f / Global_Light_Source::STATE_CROSSFADE_FRAMES;
+
+// Sprite mips and impostor tiles not drawn for MIP_IDLE_MS are dropped from
+// VRAM; checked every MIP_EVICT_INTERVAL frames.
+static constexpr int    MIP_EVICT_INTERVAL = 300;
+static constexpr Uint32 MIP_IDLE_MS        = 10000;
+
+// Static chunk textures baked per frame at most, and chunks checked for it.
+static constexpr int CHUNK_BAKES_PER_FRAME = 2;
+static constexpr int CHUNK_BAKE_ATTEMPTS   = 8;
+
+// Salts keeping DirtyTracker keys of different kinds of draws apart.
+static constexpr std::uint64_t DIRTY_SPRITE = 1;
+static constexpr std::uint64_t DIRTY_SHADOW = 2;
+static constexpr std::uint64_t DIRTY_CHUNK  = 3;
+static constexpr std::uint64_t DIRTY_TILES  = 4;
+static constexpr std::uint64_t DIRTY_LIGHT  = 5;
+static constexpr std::uint64_t DIRTY_GLOBAL = 6;
+// Window pixels around a dirty rect that are redrawn too, for filtering when
+// the world target is scaled.
+static constexpr int DIRTY_PAD = 2;
+
+// Intro view scales over which the map impostor fades into live rendering.
+// Above IMPOSTOR_FADE_START only the impostor is drawn.
+static constexpr float IMPOSTOR_FADE_START = 3.0f;
+static constexpr float IMPOSTOR_FADE_END   = 1.5f;
+
 SceneRenderer::SceneRenderer(SDL_Renderer* renderer,
                              Assets* assets,
                              RenderUtils& util,
@@ -29,7 +73,13 @@ SceneRenderer::SceneRenderer(SDL_Renderer* renderer,
       main_light_source_(renderer, screen_width / 2, screen_height / 2,
                          screen_width, SDL_Color{255, 255, 255, 255}, map_path),
       fullscreen_light_tex_(nullptr),
-      render_asset_(renderer, util, main_light_source_, assets->player)
+      render_asset_(renderer, util, main_light_source_, assets->player),
+      impostor_(renderer, util, render_asset_, screen_width, screen_height),
+      impostor_tiles_(renderer, util, render_asset_, screen_width, screen_height),
+      regen_scheduler_(REGEN_BUDGET_US),
+      chunk_cache_(renderer),
+      cast_shadows_(renderer, screen_width, screen_height),
+      dirty_(screen_width, screen_height)
 {
     fullscreen_light_tex_ = SDL_CreateTexture(renderer_,
                                               SDL_PIXELFORMAT_RGBA8888,
@@ -59,25 +109,146 @@ SceneRenderer::SceneRenderer(SDL_Renderer* renderer,
                                                screen_height_,
                                                fullscreen_light_tex_);
 
+    impostor_tiles_.build(assets_->all);
+
     main_light_source_.update();
     z_light_pass_->render(debugging);
 }
 
-void SceneRenderer::update_shading_groups() {
-    ++current_shading_group_;
-    if (current_shading_group_ > num_groups_)
-        current_shading_group_ = 1;
+SceneRenderer::~SceneRenderer() {
+    if (world_target_) SDL_DestroyTexture(world_target_);
+}
+
+SDL_Texture* SceneRenderer::bind_world_target(float render_scale, bool persistent) {
+    if (render_scale >= 1.0f && !persistent) {
+        SDL_SetRenderTarget(renderer_, nullptr);
+        return nullptr;
+    }
+
+    const float s = std::min(render_scale, 1.0f);
+    const int w = std::max(1, static_cast<int>(screen_width_  * s));
+    const int h = std::max(1, static_cast<int>(screen_height_ * s));
+    if (!world_target_ || w != world_w_ || h != world_h_) {
+        if (world_target_) SDL_DestroyTexture(world_target_);
+        world_valid_ = false;
+        world_target_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
+                                          SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!world_target_) {
+            std::cerr << "[SceneRenderer] Failed to create world target: " << SDL_GetError() << "\n";
+            world_w_ = world_h_ = 0;
+            SDL_SetRenderTarget(renderer_, nullptr);
+            return nullptr;
+        }
+        world_w_ = w;
+        world_h_ = h;
+        SDL_SetTextureBlendMode(world_target_, SDL_BLENDMODE_NONE);
+        SDL_SetTextureScaleMode(world_target_, SDL_ScaleModeLinear);
+    }
+    SDL_SetRenderTarget(renderer_, world_target_);
+    return world_target_;
+}
+
+// The intro thins out far boundary decoration; the impostor follows suit so
+// the two match during the crossfade.
+static bool hidden_in_intro(const Asset* a, int px, int py) {
+    const int dx = a->pos_X - px;
+    const int dy = a->pos_Y - py;
+    return dx * dx + dy * dy > 1200 * 1200 &&
+           a->info->type == "boundary" &&
+           a->get_shading_group() % 2 != 0;
 }
 
-bool SceneRenderer::shouldRegen(Asset* a) {
-    if (!a->get_final_texture()){return true;}
-    if (assets_->getView().intro){return false;}
-        update_shading_groups();
-    return (a->get_shading_group() > 0 &&
-            a->get_shading_group() == current_shading_group_) ||
-           (!a->get_final_texture() ||
-            !a->static_frame ||
-            a->get_render_player_light());
+void SceneRenderer::bake_impostor(float scale, int px, int py) {
+    std::vector<Asset*> assets;
+    assets.reserve(assets_->all.size());
+    for (Asset& a : assets_->all) {
+        if (a.info && !hidden_in_intro(&a, px, py)) assets.push_back(&a);
+    }
+    std::stable_sort(assets.begin(), assets.end(),
+                     [](const Asset* A, const Asset* B) { return A->z_index < B->z_index; });
+
+    // The impostor shows lit assets as the live pass will once it takes over,
+    // so every one of them needs its final texture. Instances sharing a key
+    // share the bake, which keeps this to a bake per kind of asset and light.
+    const int state = main_light_source_.get_state_index();
+    int baked = 0;
+    for (Asset* a : assets) {
+        if (a->get_final_texture() || !a->get_current_frame() || render_asset_.is_uniformly_lit(a)) continue;
+        const std::uint64_t key = compute_regen_key(a, state);
+        auto shared = lit_cache_.find(key);
+        if (!shared) {
+            SDL_Texture* tex = render_asset_.regenerateFinalTexture(a);
+            if (!tex) continue;
+            shared = lit_cache_.insert(key, tex);
+            ++baked;
+        }
+        a->set_final_texture(std::move(shared), key, state);
+    }
+    if (baked > 0) std::cout << "[SceneRenderer] Baked " << baked << " lit textures for the impostor\n";
+
+    impostor_.bake(scale, IMPOSTOR_FADE_END, assets);
+}
+
+static SDL_Rect scale_rect(const SDL_Rect& r, float s) {
+    if (s == 1.0f) return r;
+    const int x0 = static_cast<int>(std::lround(r.x * s));
+    const int y0 = static_cast<int>(std::lround(r.y * s));
+    const int x1 = static_cast<int>(std::lround((r.x + r.w) * s));
+    const int y1 = static_cast<int>(std::lround((r.y + r.h) * s));
+    return SDL_Rect{ x0, y0, x1 - x0, y1 - y0 };
+}
+
+// The key describes the bake completely (relative light placement only), so it
+// doubles as the LitTextureCache key shared between instances.
+std::uint64_t SceneRenderer::compute_regen_key(const Asset* a, int lighting_state) const {
+    std::uint64_t key = HashUtils::SEED;
+    HashUtils::combine_ptr(key, a->get_current_frame());
+    HashUtils::combine(key, a->flipped ? 1 : 0);
+    HashUtils::combine(key, static_cast<std::uint64_t>(std::clamp(a->alpha_percentage, 0.0, 1.0) * 255.0));
+    if (a == assets_->player) HashUtils::combine_ptr(key, a);
+
+    HashUtils::combine(key, static_cast<std::uint64_t>(lighting_state + 1));
+
+    // Only shaded assets receive light contributions (see RenderAsset).
+    if (!a->has_shading) return key;
+
+    if (a->info && !a->info->orbital_light_sources.empty()) {
+        const float turn = main_light_source_.get_angle() / (2.0f * float(M_PI));
+        HashUtils::combine(key, static_cast<std::uint64_t>(turn * ANGLE_BUCKETS));
+    }
+
+    Asset* player = assets_->player;
+    if (player && a->get_render_player_light()) {
+        const int dx = (player->pos_X - a->pos_X) / PLAYER_LIGHT_BUCKET;
+        const int dy = (player->pos_Y - a->pos_Y) / PLAYER_LIGHT_BUCKET;
+        const double factor = LightUtils::calculate_static_alpha_percentage(a, player);
+        HashUtils::combine(key, (std::uint64_t(std::uint32_t(dx)) << 32) | std::uint32_t(dy));
+        HashUtils::combine(key, static_cast<std::uint64_t>(factor * LIGHT_FACTOR_STEPS));
+    }
+
+    HashUtils::combine(key, a->static_light_signature);
+    for (const auto& sl : a->static_lights) {
+        if (sl.source && sl.source->flicker > 0) {
+            HashUtils::combine(key, flicker_phase_);
+            break;
+        }
+    }
+    return key;
+}
+
+std::uint64_t SceneRenderer::tile_look_key(int lighting_state) const {
+    // Orbital shading moves in the same steps as it does for live sprites.
+    const float turn = main_light_source_.get_angle() / (2.0f * float(M_PI));
+    std::uint64_t key = HashUtils::SEED;
+    HashUtils::combine(key, static_cast<std::uint64_t>(lighting_state + 1));
+    HashUtils::combine(key, static_cast<std::uint64_t>(turn * ANGLE_BUCKETS));
+    return key;
+}
+
+bool SceneRenderer::shouldRegen(Asset* a, std::uint64_t key) {
+    if (!a->get_final_texture()) return true;
+    if (assets_->getView().intro) return false;
+    return a->get_final_texture_key() != key;
 }
 
 SDL_Rect SceneRenderer::get_scaled_position_rect(Asset* a, int fw, int fh, float inv_scale, int min_w, int min_h) {
@@ -94,14 +265,324 @@ SDL_Rect SceneRenderer::get_scaled_position_rect(Asset* a, int fw, int fh, float
     return SDL_Rect{ cp.x - sw / 2, cp.y - sh, sw, sh };
 }
 
-void SceneRenderer::render() {
-    static int render_call_count = 0;
-    ++render_call_count;
-    if (!assets_->getView().intro){
-                update_shading_groups();
+void SceneRenderer::draw_item(const DrawItem& item, const SDL_Rect& dst) {
+    if (item.tile >= 0) {
+        impostor_tiles_.draw(item.tile, dst);
+        return;
     }
+    Asset* a = item.asset;
+    const SDL_RendererFlip flip = a->flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE;
 
+    // Until its first bake lands, a lit asset is drawn through the fast path too.
+    SDL_Texture* final_tex = item.uniform ? nullptr : a->get_final_texture();
+    if (final_tex) {
+        SDL_Texture* prev_tex = a->get_previous_final_texture();
+        if (prev_tex && item.fade < 1.0f) {
+            SDL_RenderCopyEx(renderer_, prev_tex, nullptr, &dst, 0, nullptr, flip);
+            SDL_SetTextureAlphaMod(final_tex, static_cast<Uint8>(item.fade * 255.0f));
+            SDL_RenderCopyEx(renderer_, final_tex, nullptr, &dst, 0, nullptr, flip);
+            SDL_SetTextureAlphaMod(final_tex, 255);
+        } else {
+            SDL_RenderCopyEx(renderer_, final_tex, nullptr, &dst, 0, nullptr, flip);
+        }
+        return;
+    }
+
+    // Far zoom draws sprites at a fraction of their size; sample a mip instead.
+    SDL_Texture* frame = a->get_current_frame_lod(dst.w, dst.h);
+    const SDL_Color mod = frame_color_mod(item);
+    SDL_SetTextureColorMod(frame, mod.r, mod.g, mod.b);
+    SDL_SetTextureAlphaMod(frame, mod.a);
+    SDL_RenderCopyEx(renderer_, frame, nullptr, &dst, 0, nullptr, flip);
+    SDL_SetTextureColorMod(frame, 255, 255, 255);
+    SDL_SetTextureAlphaMod(frame, 255);
+}
+
+SDL_Color SceneRenderer::frame_color_mod(const DrawItem& item) const {
+    if (item.uniform) return render_asset_.uniform_color_mod(item.asset);
+    // A lit asset whose first bake has not landed yet: its ambient tint is a
+    // far closer stand-in than the black of a fully masked silhouette.
+    return render_asset_.ambient_color_mod(item.asset);
+}
+
+bool SceneRenderer::is_chunk_static(const Asset* a, int cx0, int cy0, int cx1, int cy1) const {
+    if (a == assets_->player || !a->static_frame || a->get_render_player_light()) return false;
+    return assets_->getActiveManager().inStaticChunks(*a, cx0, cy0, cx1, cy1);
+}
+
+// Nonzero key of what the chunk's texture would show, or false while any of
+// its members has to be drawn per sprite.
+bool SceneRenderer::chunk_content_key(const std::vector<Asset*>& members, int lighting_state,
+                                      std::uint64_t& out) const {
+    std::uint64_t key = HashUtils::SEED;
+    HashUtils::combine(key, static_cast<std::uint64_t>(lighting_state + 1));
+    for (const Asset* m : members) {
+        int cx0, cy0, cx1, cy1;
+        if (!ActiveAssetsManager::chunkSpan(*m, cx0, cy0, cx1, cy1) ||
+            !is_chunk_static(m, cx0, cy0, cx1, cy1)) {
+            return false;
+        }
+        HashUtils::combine_ptr(key, m->get_current_frame());
+        HashUtils::combine(key, m->flipped ? 1 : 0);
+    }
+    out = key ? key : 1;
+    return true;
+}
+
+void SceneRenderer::prepare_chunks(const std::vector<Asset*>& assets, int lighting_state, Uint32 now) {
+    frame_chunks_.clear();
+    sprite_chunks_.clear();
+    chunk_draws_.clear();
+
+    // Chunks under anything that cannot be baked are drawn per sprite, so it
+    // interleaves in z with the scenery around it.
+    for (const Asset* a : assets) {
+        if (!a || !a->info) continue;
+        if (!a->merged_sprites.empty() && impostor_tiles_.ready()) continue;
+        int cx0, cy0, cx1, cy1;
+        if (!ActiveAssetsManager::chunkSpan(*a, cx0, cy0, cx1, cy1)) continue;
+        const bool dynamic = !is_chunk_static(a, cx0, cy0, cx1, cy1);
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const auto key = ActiveAssetsManager::makeKey(cx, cy);
+                frame_chunks_.insert(key);
+                if (dynamic) sprite_chunks_.insert(key);
+            }
+        }
+    }
+    // Tiles are drawn in z order too, so the scenery under them goes per sprite.
+    const int size = ActiveAssetsManager::STATIC_CHUNK_SIZE;
+    for (const ImpostorTiles::Draw& t : tile_draws_) {
+        const int cx0 = static_cast<int>(std::floor(float(t.world.x) / size));
+        const int cy0 = static_cast<int>(std::floor(float(t.world.y) / size));
+        const int cx1 = static_cast<int>(std::floor(float(t.world.x + t.world.w - 1) / size));
+        const int cy1 = static_cast<int>(std::floor(float(t.world.y + t.world.h - 1) / size));
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const auto key = ActiveAssetsManager::makeKey(cx, cy);
+                frame_chunks_.insert(key);
+                sprite_chunks_.insert(key);
+            }
+        }
+    }
+
+    const auto& chunks = assets_->getActiveManager().getStaticChunks();
+    for (const auto key : frame_chunks_) {
+        if (sprite_chunks_.count(key)) continue;
+        auto it = chunks.find(key);
+        std::uint64_t content = 0;
+        if (it == chunks.end() || !chunk_content_key(it->second, lighting_state, content)) {
+            sprite_chunks_.insert(key);
+            continue;
+        }
+        SDL_Texture* tex = chunk_cache_.find(key, content, now);
+        if (!tex) sprite_chunks_.insert(key);
+        chunk_draws_.push_back({ key, content, tex });
+    }
+}
 
+void SceneRenderer::bake_chunks(int lighting_state, int min_w, int min_h, Uint32 now) {
+    // Uniform members take the blended tint, which only matches lighting_state
+    // (the content key) once the crossfade has settled.
+    if (main_light_source_.get_crossfade() < 1.0f) return;
+
+    const auto& chunks = assets_->getActiveManager().getStaticChunks();
+    const int size = ActiveAssetsManager::STATIC_CHUNK_SIZE;
+    int attempts = 0;
+    int baked = 0;
+
+    for (const ChunkDraw& cd : chunk_draws_) {
+        if (cd.texture) continue;
+        if (attempts++ >= CHUNK_BAKE_ATTEMPTS || baked >= CHUNK_BAKES_PER_FRAME) break;
+        const std::vector<Asset*>& members = chunks.at(cd.key);
+
+        // Lit members must show their settled bake for this state.
+        bool ready = true;
+        for (Asset* m : members) {
+            if (render_asset_.is_uniformly_lit(m)) continue;
+            if (!m->get_final_texture() || m->get_previous_final_texture() ||
+                m->get_final_texture_key() != compute_regen_key(m, lighting_state)) {
+                ready = false;
+                break;
+            }
+        }
+        if (!ready || !chunk_cache_.begin_bake(cd.key, cd.content_key, now)) continue;
+
+        const int ox = ActiveAssetsManager::keyX(cd.key) * size;
+        const int oy = ActiveAssetsManager::keyY(cd.key) * size;
+        for (Asset* m : members) {
+            SDL_Texture* frame = m->get_current_frame();
+            int fw = m->cached_w;
+            int fh = m->cached_h;
+            if (fw == 0 || fh == 0) SDL_QueryTexture(frame, nullptr, nullptr, &fw, &fh);
+            // Same cut-off as the per-sprite pass at scale 1.
+            if (fw < min_w && fh < min_h) continue;
+            const SDL_Rect dst{ m->pos_X - fw / 2 - ox, m->pos_Y - fh - oy, fw, fh };
+            draw_item({ m, dst, render_asset_.is_uniformly_lit(m) }, dst);
+        }
+        chunk_cache_.end_bake();
+        ++baked;
+    }
+}
+
+SDL_Rect SceneRenderer::chunk_screen_rect(int cx0, int cy0, int cx1, int cy1) const {
+    // Corners go through the sprite projection at scale 1, so neighbouring
+    // chunks and sprite regions share edges exactly.
+    const int size = ActiveAssetsManager::STATIC_CHUNK_SIZE;
+    const SDL_Point p0 = util_.applyParallax(cx0 * size, cy0 * size);
+    const SDL_Point p1 = util_.applyParallax(cx1 * size, cy1 * size);
+    return SDL_Rect{ p0.x, p0.y, p1.x - p0.x, p1.y - p0.y };
+}
+
+void SceneRenderer::draw_chunks(float world_scale, const SDL_Rect* area) {
+    for (const ChunkDraw& cd : chunk_draws_) {
+        if (!cd.texture || sprite_chunks_.count(cd.key)) continue;
+        const int cx = ActiveAssetsManager::keyX(cd.key);
+        const int cy = ActiveAssetsManager::keyY(cd.key);
+        const SDL_Rect dst = scale_rect(chunk_screen_rect(cx, cy, cx + 1, cy + 1), world_scale);
+        if (area && !SDL_HasIntersection(&dst, area)) continue;
+        SDL_RenderCopy(renderer_, cd.texture, nullptr, &dst);
+    }
+
+    // Per-sprite chunks are merged into rectangles: runs along each row,
+    // extended downwards while the next row has the same run. Each is drawn
+    // with the sprites crossing it, clipped to it.
+    std::vector<std::pair<int, int>> cells;
+    cells.reserve(sprite_chunks_.size());
+    for (const auto key : sprite_chunks_) {
+        cells.emplace_back(ActiveAssetsManager::keyY(key), ActiveAssetsManager::keyX(key));
+    }
+    std::sort(cells.begin(), cells.end());
+
+    std::vector<SDL_Rect> regions;   // in chunks
+    std::vector<size_t> open;        // regions ending on the previous row
+    std::vector<size_t> next_open;
+    for (size_t i = 0; i < cells.size();) {
+        const int row = cells[i].first;
+        next_open.clear();
+        while (i < cells.size() && cells[i].first == row) {
+            const int x0 = cells[i].second;
+            int x1 = x0 + 1;
+            ++i;
+            while (i < cells.size() && cells[i].first == row && cells[i].second == x1) { ++x1; ++i; }
+
+            size_t idx = regions.size();
+            for (size_t r : open) {
+                const SDL_Rect& g = regions[r];
+                if (g.x == x0 && g.w == x1 - x0 && g.y + g.h == row) { idx = r; break; }
+            }
+            if (idx == regions.size()) regions.push_back({ x0, row, x1 - x0, 1 });
+            else ++regions[idx].h;
+            next_open.push_back(idx);
+        }
+        open.swap(next_open);
+    }
+
+    for (const SDL_Rect& g : regions) {
+        const SDL_Rect region = chunk_screen_rect(g.x, g.y, g.x + g.w, g.y + g.h);
+        SDL_Rect clip = scale_rect(region, world_scale);
+        if (area && !SDL_IntersectRect(&clip, area, &clip)) continue;
+        SDL_RenderSetClipRect(renderer_, &clip);
+        for (const DrawItem& item : draw_list_) {
+            if (!SDL_HasIntersection(&item.dst, &region)) continue;
+            const SDL_Rect dst = scale_rect(item.dst, world_scale);
+            if (SDL_HasIntersection(&dst, &clip)) draw_item(item, dst);
+        }
+    }
+    SDL_RenderSetClipRect(renderer_, area);
+}
+
+static std::uint64_t dirty_key(std::uint64_t salt, std::uint64_t id) {
+    std::uint64_t key = HashUtils::SEED;
+    HashUtils::combine(key, salt);
+    HashUtils::combine(key, id);
+    return key;
+}
+
+static std::uint64_t pack_color(SDL_Color c) {
+    return (std::uint64_t(c.r) << 24) | (std::uint64_t(c.g) << 16) | (std::uint64_t(c.b) << 8) | c.a;
+}
+
+void SceneRenderer::record_frame(bool shadows, bool use_chunks) {
+    const SDL_Rect screen{ 0, 0, screen_width_, screen_height_ };
+    dirty_.begin_frame();
+
+    // Whatever tints or skews the whole frame at once.
+    std::uint64_t global = HashUtils::SEED;
+    HashUtils::combine(global, pack_color(main_light_source_.get_blended_tint()));
+    HashUtils::combine(global, pack_color(main_light_source_.get_blended_color()));
+    HashUtils::combine(global, static_cast<std::uint64_t>(z_light_pass_->get_downscale()));
+    dirty_.record(dirty_key(DIRTY_GLOBAL, 0), global, screen);
+
+    for (const DrawItem& item : draw_list_) {
+        if (item.tile >= 0) {
+            dirty_.record(dirty_key(DIRTY_TILES, static_cast<std::uint64_t>(item.tile)),
+                          impostor_tiles_.look(item.tile), item.dst);
+            continue;
+        }
+        const Asset* a = item.asset;
+        std::uint64_t look = HashUtils::SEED;
+        HashUtils::combine_ptr(look, a->get_current_frame());
+        HashUtils::combine(look, a->flipped ? 1 : 0);
+        if (item.uniform || !a->get_final_texture()) {
+            HashUtils::combine(look, pack_color(frame_color_mod(item)));
+        } else {
+            HashUtils::combine(look, a->get_final_texture_key());
+            HashUtils::combine_ptr(look, a->get_final_texture());
+            HashUtils::combine_ptr(look, a->get_previous_final_texture());
+            HashUtils::combine(look, static_cast<std::uint64_t>(item.fade * 255.0f));
+        }
+        dirty_.record(dirty_key(DIRTY_SPRITE, reinterpret_cast<std::uintptr_t>(a)), look, item.dst);
+    }
+
+    if (shadows) {
+        const float angle = main_light_source_.get_angle();
+        auto record_shadow = [&](const DrawItem& item) {
+            const Asset* a = item.asset;
+            if (item.tile >= 0 || !a->info || !a->info->has_casted_shadows) return;
+            std::uint64_t look = HashUtils::SEED;
+            HashUtils::combine_ptr(look, a->get_current_silhouette());
+            HashUtils::combine(look, a->flipped ? 1 : 0);
+            HashUtils::combine(look, static_cast<std::uint64_t>(std::lround(angle * 1e5f)));
+            dirty_.record(dirty_key(DIRTY_SHADOW, reinterpret_cast<std::uintptr_t>(a)), look,
+                          CastShadowPass::bounds(item.dst));
+        };
+        for (const DrawItem& item : draw_list_) record_shadow(item);
+        for (const DrawItem& item : shadow_only_) record_shadow(item);
+    }
+
+    if (use_chunks) {
+        for (const ChunkDraw& cd : chunk_draws_) {
+            const bool drawn = cd.texture && !sprite_chunks_.count(cd.key);
+            const int cx = ActiveAssetsManager::keyX(cd.key);
+            const int cy = ActiveAssetsManager::keyY(cd.key);
+            dirty_.record(dirty_key(DIRTY_CHUNK, static_cast<std::uint64_t>(cd.key)),
+                          drawn ? cd.content_key : 0, chunk_screen_rect(cx, cy, cx + 1, cy + 1));
+        }
+    }
+
+    // The mask is sampled at light resolution, so a light touches a texel
+    // or two around its rect.
+    const int pad = 2 * z_light_pass_->get_downscale();
+    for (const LightMap::LightEntry& e : z_light_pass_->get_layers()) {
+        std::uint64_t look = HashUtils::SEED;
+        HashUtils::combine(look, (std::uint64_t(std::uint32_t(e.dst.x)) << 32) | std::uint32_t(e.dst.y));
+        HashUtils::combine(look, (std::uint64_t(std::uint32_t(e.dst.w)) << 32) | std::uint32_t(e.dst.h));
+        HashUtils::combine(look, (std::uint64_t(e.alpha) << 16) | (std::uint64_t(e.flip) << 1) |
+                                 std::uint64_t(e.apply_tint));
+        const SDL_Rect r{ e.dst.x - pad, e.dst.y - pad, e.dst.w + 2 * pad, e.dst.h + 2 * pad };
+        dirty_.record(dirty_key(DIRTY_LIGHT, reinterpret_cast<std::uintptr_t>(e.tex)), look, r);
+    }
+}
+
+void SceneRenderer::render() {
+    frame_time_.begin_frame();
+
+    static int render_call_count = 0;
+    ++render_call_count;
+    flicker_phase_ = static_cast<std::uint32_t>(render_call_count / LightUtils::FLICKER_INTERVAL_FRAMES);
+    render_asset_.set_flicker_phase(flicker_phase_);
+    z_light_pass_->set_flicker_phase(flicker_phase_);
 
     int px = assets_->player ? assets_->player->pos_X : 0;
     int py = assets_->player ? assets_->player->pos_Y : 0;
@@ -109,9 +590,6 @@ void SceneRenderer::render() {
 
     main_light_source_.update();
 
-    SDL_SetRenderDrawColor(renderer_, SLATE_COLOR.r, SLATE_COLOR.g, SLATE_COLOR.b, SLATE_COLOR.a);
-    SDL_RenderClear(renderer_);
-
     const auto& view_state = assets_->getView();
     float scale = view_state.get_scale();
     float inv_scale = 1.0f / scale;
@@ -125,45 +603,224 @@ void SceneRenderer::render() {
         min_visible_h = 20;
     }
 
-    for (Asset* a : assets_->active_assets) {
-        if (!a || !a->info) continue;
+    // Far out in the intro the map is drawn from the impostor alone, which
+    // also keeps the thousands of assets in view out of the regen queue.
+    float impostor_alpha = 0.0f;
+    if (intro_mode && scale > IMPOSTOR_FADE_END) {
+        if (!impostor_baked_) {
+            bake_impostor(scale, px, py);
+            impostor_baked_ = true;
+        }
+        if (impostor_.ready()) {
+            impostor_alpha = std::clamp((scale - IMPOSTOR_FADE_END) / (IMPOSTOR_FADE_START - IMPOSTOR_FADE_END),
+                                        0.0f, 1.0f);
+        }
+    } else if (impostor_.ready()) {
+        impostor_.release();
+    }
+    static const std::vector<Asset*> no_assets;
+    const std::vector<Asset*>& live_assets = impostor_alpha < 1.0f ? assets_->active_assets : no_assets;
+
+    draw_list_.clear();
+    shadow_only_.clear();
+    regen_scheduler_.begin_frame();
+
+    const int state = main_light_source_.get_state_index();
+    int next_state = main_light_source_.get_next_state_index();
+    if (intro_mode || next_state == state) next_state = -1;
+
+    // Chunk textures are baked one texel per world pixel, for gameplay zoom.
+    const Uint32 now = SDL_GetTicks();
+    const bool use_chunks = !intro_mode && std::fabs(scale - 1.0f) < 1e-3f &&
+                            !assets_->getActiveManager().getStaticChunks().empty();
 
+    // Merged assets draw their tile in their place in z order; a tile shows
+    // while any of it is in view, not just the asset's own frame.
+    tile_draws_.clear();
+    if (!live_assets.empty() && impostor_tiles_.ready()) {
+        impostor_tiles_.prepare(inv_scale, tile_look_key(state), now, tile_draws_);
         if (intro_mode) {
-            int dx = a->pos_X - px;
-            int dy = a->pos_Y - py;
-            if ((!((dx * dx + dy * dy) <= (1200 * 1200))) &&
-                a->info->type == "boundary" &&
-                (a->get_shading_group() % 2 != 0)) {
-                continue;
-            }
+            tile_draws_.erase(std::remove_if(tile_draws_.begin(), tile_draws_.end(),
+                                             [&](const ImpostorTiles::Draw& t) { return hidden_in_intro(t.owner, px, py); }),
+                              tile_draws_.end());
         }
+    }
+    if (use_chunks) prepare_chunks(live_assets, state, now);
 
-        if (shouldRegen(a)) {
-            SDL_Texture* tex = render_asset_.regenerateFinalTexture(a);
-            a->set_final_texture(tex);
-            if (tex) SDL_QueryTexture(tex, nullptr, nullptr, &a->cached_w, &a->cached_h);
-        }
+    for (Asset* a : live_assets) {
+        if (!a || !a->info) continue;
+        if (intro_mode && hidden_in_intro(a, px, py)) continue;
+        // Merged assets are drawn as their tile (tile_draws_).
+        if (!a->merged_sprites.empty() && impostor_tiles_.ready()) continue;
 
-        SDL_Texture* final_tex = a->get_final_texture();
-        if (!final_tex) continue;
+        SDL_Texture* frame = a->get_current_frame();
+        if (!frame) continue;
 
         int fw = a->cached_w;
         int fh = a->cached_h;
-        if (fw == 0 || fh == 0) SDL_QueryTexture(final_tex, nullptr, nullptr, &fw, &fh);
+        if (fw == 0 || fh == 0) SDL_QueryTexture(frame, nullptr, nullptr, &fw, &fh);
 
         SDL_Rect fb = get_scaled_position_rect(a, fw, fh, inv_scale, min_visible_w, min_visible_h);
         if (fb.w == 0 && fb.h == 0) continue;
 
-        SDL_RenderCopyEx(renderer_,
-                         final_tex,
-                         nullptr,
-                         &fb,
-                         0,
-                         nullptr,
-                         a->flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+        if (use_chunks) {
+            int cx0, cy0, cx1, cy1;
+            bool baked = ActiveAssetsManager::chunkSpan(*a, cx0, cy0, cx1, cy1) &&
+                         is_chunk_static(a, cx0, cy0, cx1, cy1);
+            for (int cy = cy0; baked && cy <= cy1; ++cy) {
+                for (int cx = cx0; baked && cx <= cx1; ++cx) {
+                    baked = !sprite_chunks_.count(ActiveAssetsManager::makeKey(cx, cy));
+                }
+            }
+            if (baked) {
+                if (a->info->has_casted_shadows) shadow_only_.push_back({ a, fb, true });
+                continue;
+            }
+        }
+
+        if (render_asset_.is_uniformly_lit(a)) {
+            // No per-pixel lighting: drop the bake and its VRAM entirely.
+            if (a->get_final_texture()) a->set_final_texture(nullptr);
+            draw_list_.push_back({ a, fb, true });
+            continue;
+        }
+
+        const std::uint64_t key = compute_regen_key(a, state);
+        if (shouldRegen(a, key)) {
+            if (auto variant = a->take_state_variant(key)) {
+                a->set_final_texture(std::move(variant), key, state);
+            } else if (auto shared = lit_cache_.find(key)) {
+                a->set_final_texture(std::move(shared), key, state);
+            } else {
+                regen_scheduler_.request(a, key, fb, px, py);
+            }
+        } else if (next_state >= 0 && render_asset_.has_time_of_day_variants(a)) {
+            // Up to date: bake the next state's variant ahead of the step.
+            const std::uint64_t next_key = compute_regen_key(a, next_state);
+            if (a->get_state_variant_key() != next_key) {
+                if (auto shared = lit_cache_.find(next_key)) {
+                    a->set_state_variant(std::move(shared), next_key);
+                } else {
+                    regen_scheduler_.prefetch(a, next_key, next_state);
+                }
+            }
+        }
+        draw_list_.push_back({ a, fb, false });
     }
 
-    z_light_pass_->render(debugging);
+    const size_t sprite_count = draw_list_.size();
+    for (const ImpostorTiles::Draw& t : tile_draws_) {
+        DrawItem item{ t.owner, t.dst, true };
+        item.tile = t.leaf;
+        draw_list_.push_back(item);
+    }
+    std::inplace_merge(draw_list_.begin(), draw_list_.begin() + sprite_count, draw_list_.end(),
+                       [](const DrawItem& A, const DrawItem& B) { return A.asset->z_index < B.asset->z_index; });
+
+    regen_scheduler_.run(render_asset_, lit_cache_);
+    if (use_chunks) bake_chunks(state, min_visible_w, min_visible_h, now);
+
+    const float state_fade = main_light_source_.get_crossfade();
+    for (DrawItem& item : draw_list_) {
+        item.fade = item.uniform ? 1.0f
+                                 : item.asset->advance_final_texture_fade(STATE_FADE_STEP, state, state_fade);
+    }
+
+    // Bakes are done; everything below is the world pass, drawn at the scale
+    // the frame-time controller picked and stretched to the window at the end.
+    const float render_scale = frame_time_.get_render_scale();
+    z_light_pass_->set_downscale(frame_time_.get_light_downscale());
+    z_light_pass_->prepare();
+
+    // Ground shadows go under every sprite, so they are queued as one pass.
+    const bool shadows = cast_shadows_.begin(main_light_source_);
+
+    // While the view holds still, the world target is kept between frames and
+    // only the regions whose contents changed are redrawn into it.
+    std::uint64_t view_key = HashUtils::SEED;
+    HashUtils::combine(view_key, (std::uint64_t(std::uint32_t(px)) << 32) | std::uint32_t(py));
+    HashUtils::combine(view_key, static_cast<std::uint64_t>(std::lround(scale * 1e4f)));
+    HashUtils::combine(view_key, static_cast<std::uint64_t>(std::lround(render_scale * 1e4f)));
+    HashUtils::combine(view_key, static_cast<std::uint64_t>(use_chunks));
+    const bool still = !intro_mode && view_key == last_view_key_;
+    last_view_key_ = view_key;
+
+    SDL_Texture* world_target = bind_world_target(render_scale, still);
+    const float world_scale = world_target ? std::min(render_scale, 1.0f) : 1.0f;
+
+    record_frame(shadows, use_chunks);
+    if (!still || !world_valid_) dirty_.reset();
+    const bool partial = dirty_.end_frame();
+
+    auto draw_world = [&](const SDL_Rect* area) {
+        SDL_SetRenderDrawColor(renderer_, SLATE_COLOR.r, SLATE_COLOR.g, SLATE_COLOR.b, SLATE_COLOR.a);
+        if (area) {
+            // RenderClear ignores the clip rect.
+            SDL_BlendMode prev_mode;
+            SDL_GetRenderDrawBlendMode(renderer_, &prev_mode);
+            SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_NONE);
+            SDL_RenderSetClipRect(renderer_, area);
+            SDL_RenderFillRect(renderer_, area);
+            SDL_SetRenderDrawBlendMode(renderer_, prev_mode);
+        } else {
+            SDL_RenderClear(renderer_);
+        }
+
+        cast_shadows_.composite(area);
+
+        if (use_chunks) {
+            draw_chunks(world_scale, area);
+        } else {
+            for (const DrawItem& item : draw_list_) {
+                const SDL_Rect dst = scale_rect(item.dst, world_scale);
+                if (!area || SDL_HasIntersection(&dst, area)) draw_item(item, dst);
+            }
+        }
+
+        if (impostor_alpha > 0.0f) {
+            impostor_.render(scale, world_scale, static_cast<Uint8>(impostor_alpha * 255.0f));
+        }
+
+        z_light_pass_->composite(area);
+        SDL_RenderSetClipRect(renderer_, nullptr);
+    };
+
+    const std::vector<SDL_Rect>& dirty = dirty_.get_dirty();
+    if (!partial || !dirty.empty()) {
+        if (shadows) {
+            for (const DrawItem& item : draw_list_) {
+                if (item.tile < 0) cast_shadows_.add(item.asset, scale_rect(item.dst, world_scale));
+            }
+            for (const DrawItem& item : shadow_only_) cast_shadows_.add(item.asset, scale_rect(item.dst, world_scale));
+            cast_shadows_.build();
+        }
+        if (!partial) {
+            draw_world(nullptr);
+        } else {
+            const SDL_Rect target{ 0, 0, world_w_, world_h_ };
+            for (const SDL_Rect& r : dirty) {
+                SDL_Rect area = scale_rect(r, world_scale);
+                area = SDL_Rect{ area.x - DIRTY_PAD, area.y - DIRTY_PAD,
+                                 area.w + 2 * DIRTY_PAD, area.h + 2 * DIRTY_PAD };
+                if (SDL_IntersectRect(&area, &target, &area)) draw_world(&area);
+            }
+        }
+    }
+    world_valid_ = world_target != nullptr;
+
+    if (render_call_count % MIP_EVICT_INTERVAL == 0) {
+        std::unordered_set<AssetInfo*> seen;
+        for (Asset& a : assets_->all) {
+            if (a.info && seen.insert(a.info.get()).second) a.info->evict_unused_mips(now, MIP_IDLE_MS);
+        }
+        impostor_tiles_.evict(now, MIP_IDLE_MS);
+        chunk_cache_.evict(now, MIP_IDLE_MS);
+    }
+
+    if (world_target) {
+        SDL_SetRenderTarget(renderer_, nullptr);
+        SDL_RenderCopy(renderer_, world_target, nullptr, nullptr);
+    }
     util_.renderMinimap();
 
     // Present every 100 calls
@@ -171,4 +828,6 @@ void SceneRenderer::render() {
         SDL_RenderPresent(renderer_);
     }
 
+    frame_time_.end_frame();
+
 }
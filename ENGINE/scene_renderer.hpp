@@ -3,10 +3,21 @@
 
 #include <string>
 #include <memory>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
 #include <SDL.h>
 #include "light_map.hpp"
 #include "global_light_source.hpp"
 #include "render_asset.hpp"
+#include "regen_scheduler.hpp"
+#include "lit_texture_cache.hpp"
+#include "cast_shadow_pass.hpp"
+#include "frame_time_controller.hpp"
+#include "map_impostor.hpp"
+#include "impostor_tiles.hpp"
+#include "static_chunk_cache.hpp"
+#include "dirty_tracker.hpp"
 
 class Assets;
 class Asset;
@@ -20,12 +31,66 @@ public:
                   int screen_width,
                   int screen_height,
                   const std::string& map_path);
+    ~SceneRenderer();
+
+    SceneRenderer(const SceneRenderer&) = delete;
+    SceneRenderer& operator=(const SceneRenderer&) = delete;
 
     void render();
 
+    // Per-frame time budget for final-texture regeneration, in microseconds.
+    void set_regen_budget_us(int budget_us) { regen_scheduler_.set_budget_us(budget_us); }
+
+    // Frame time the dynamic resolution scaling aims to stay under.
+    void set_frame_budget_ms(float budget_ms) { frame_time_.set_budget_ms(budget_ms); }
+
 private:
-    void update_shading_groups();
-    bool shouldRegen(Asset* a);
+    struct DrawItem {
+        Asset* asset;
+        SDL_Rect dst;
+        bool uniform;   // drawn straight from the frame with a color mod
+        float fade = 1.0f;   // weight of the final texture over the previous one
+        int tile = -1;       // ImpostorTiles leaf drawn in place of the asset
+    };
+
+    struct ChunkDraw {
+        ActiveAssetsManager::ChunkKey key;
+        std::uint64_t content_key;
+        SDL_Texture* texture;   // nullptr until baked for content_key
+    };
+
+    // Offscreen target for the world pass at render_scale of the window, or
+    // nullptr when rendering at full size (drawn straight to the window).
+    // persistent keeps a full-size target too, so the next frame can redraw
+    // only what changed; world_valid_ drops whenever the target is recreated.
+    SDL_Texture* bind_world_target(float render_scale, bool persistent);
+
+    // Records this frame's draws (in window pixels) with dirty_.
+    void record_frame(bool shadows, bool use_chunks);
+
+    void draw_item(const DrawItem& item, const SDL_Rect& dst);
+    // Color mod for an item drawn straight from its frame.
+    SDL_Color frame_color_mod(const DrawItem& item) const;
+
+    // Static chunks: is_chunk_static tells whether a can be drawn from its
+    // chunk textures (given its current chunk span). prepare_chunks sorts the
+    // chunks in view into baked ones and ones drawn per sprite, bake_chunks
+    // bakes a few of the latter once their members are lit, and draw_chunks
+    // draws both (only within area, in target pixels, if given).
+    bool is_chunk_static(const Asset* a, int cx0, int cy0, int cx1, int cy1) const;
+    bool chunk_content_key(const std::vector<Asset*>& members, int lighting_state, std::uint64_t& out) const;
+    void prepare_chunks(const std::vector<Asset*>& assets, int lighting_state, Uint32 now);
+    void bake_chunks(int lighting_state, int min_w, int min_h, Uint32 now);
+    void draw_chunks(float world_scale, const SDL_Rect* area);
+    SDL_Rect chunk_screen_rect(int cx0, int cy0, int cx1, int cy1) const;   // [cx0, cx1) x [cy0, cy1)
+
+    // Bakes the intro overview from every asset on the map, seen from (px, py).
+    void bake_impostor(float scale, int px, int py);
+
+    std::uint64_t compute_regen_key(const Asset* a, int lighting_state) const;
+    // What ImpostorTiles bakes into merged sprites: tint and orbital shading.
+    std::uint64_t tile_look_key(int lighting_state) const;
+    bool shouldRegen(Asset* a, std::uint64_t key);
     SDL_Rect get_scaled_position_rect(Asset* a,
                                       int fw,
                                       int fh,
@@ -43,9 +108,28 @@ private:
     Global_Light_Source main_light_source_;
     SDL_Texture* fullscreen_light_tex_;
     RenderAsset render_asset_;
+    MapImpostor impostor_;
+    bool impostor_baked_ = false;
+    ImpostorTiles impostor_tiles_;
+    RegenScheduler regen_scheduler_;
+    LitTextureCache lit_cache_;
+    std::vector<DrawItem> draw_list_;
+    std::vector<DrawItem> shadow_only_;   // drawn from chunk textures, shadows still cast live
+    std::vector<ImpostorTiles::Draw> tile_draws_;
+    StaticChunkCache chunk_cache_;
+    std::unordered_set<ActiveAssetsManager::ChunkKey> frame_chunks_;    // covered by a sprite in view
+    std::unordered_set<ActiveAssetsManager::ChunkKey> sprite_chunks_;   // drawn per sprite this frame
+    std::vector<ChunkDraw> chunk_draws_;
+    CastShadowPass cast_shadows_;
+    FrameTimeController frame_time_;
+    SDL_Texture* world_target_ = nullptr;
+    int world_w_ = 0;
+    int world_h_ = 0;
+    bool world_valid_ = false;          // world_target_ holds the last frame
+    DirtyTracker dirty_;
+    std::uint64_t last_view_key_ = 0;
     std::unique_ptr<LightMap> z_light_pass_;
 
-    int current_shading_group_ = 0;
-    int num_groups_ = 20;
+    std::uint32_t flicker_phase_ = 0;
     bool debugging = false;
 };
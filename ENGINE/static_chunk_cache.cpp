@@ -0,0 +1,61 @@
+// === File: static_chunk_cache.cpp ===
+#include "static_chunk_cache.hpp"
+
+#include <iostream>
+
+StaticChunkCache::StaticChunkCache(SDL_Renderer* renderer)
+    : renderer_(renderer) {}
+
+StaticChunkCache::~StaticChunkCache() {
+    for (auto& [key, e] : entries_) {
+        if (e.texture) SDL_DestroyTexture(e.texture);
+    }
+}
+
+SDL_Texture* StaticChunkCache::find(ChunkKey key, std::uint64_t content_key, Uint32 now) {
+    auto it = entries_.find(key);
+    if (it == entries_.end() || !it->second.texture || it->second.content_key != content_key) {
+        return nullptr;
+    }
+    it->second.last_used_ms = now;
+    return it->second.texture;
+}
+
+bool StaticChunkCache::begin_bake(ChunkKey key, std::uint64_t content_key, Uint32 now) {
+    Entry& e = entries_[key];
+    if (!e.texture) {
+        const int size = ActiveAssetsManager::STATIC_CHUNK_SIZE;
+        e.texture = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
+                                      SDL_TEXTUREACCESS_TARGET, size, size);
+        if (!e.texture) {
+            std::cerr << "[StaticChunkCache] Failed to create chunk texture: " << SDL_GetError() << "\n";
+            entries_.erase(key);
+            return false;
+        }
+        SDL_SetTextureBlendMode(e.texture, SDL_BLENDMODE_BLEND);
+    }
+    e.content_key = content_key;
+    e.last_used_ms = now;
+
+    prev_target_ = SDL_GetRenderTarget(renderer_);
+    SDL_SetRenderTarget(renderer_, e.texture);
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
+    SDL_RenderClear(renderer_);
+    return true;
+}
+
+void StaticChunkCache::end_bake() {
+    SDL_SetRenderTarget(renderer_, prev_target_);
+    prev_target_ = nullptr;
+}
+
+void StaticChunkCache::evict(Uint32 now, Uint32 idle_ms) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (now - it->second.last_used_ms > idle_ms) {
+            if (it->second.texture) SDL_DestroyTexture(it->second.texture);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+// === File: static_chunk_cache.hpp ===
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <unordered_map>
+#include "active_assets_manager.hpp"
+
+// Baked textures of ActiveAssetsManager's static chunks, one per chunk at one
+// texel per world pixel. Each holds every static sprite covering the chunk,
+// clipped to it, so chunk textures tile the world without overlapping. A
+// texture is only valid for the content key it was baked with (lighting
+// state and member frames, see SceneRenderer).
+class StaticChunkCache {
+public:
+    using ChunkKey = ActiveAssetsManager::ChunkKey;
+
+    explicit StaticChunkCache(SDL_Renderer* renderer);
+    ~StaticChunkCache();
+
+    StaticChunkCache(const StaticChunkCache&) = delete;
+    StaticChunkCache& operator=(const StaticChunkCache&) = delete;
+
+    // Texture of key baked for content_key, or nullptr. Marks it used.
+    SDL_Texture* find(ChunkKey key, std::uint64_t content_key, Uint32 now);
+
+    // Binds the chunk's texture, cleared, as the render target; sprites are
+    // then drawn in chunk-local world pixels. end_bake restores the target.
+    bool begin_bake(ChunkKey key, std::uint64_t content_key, Uint32 now);
+    void end_bake();
+
+    // Releases textures not drawn for idle_ms.
+    void evict(Uint32 now, Uint32 idle_ms);
+
+private:
+    struct Entry {
+        SDL_Texture* texture = nullptr;
+        std::uint64_t content_key = 0;   // 0: invalid
+        Uint32 last_used_ms = 0;
+    };
+
+    SDL_Renderer* renderer_;
+    std::unordered_map<ChunkKey, Entry> entries_;
+    SDL_Texture* prev_target_ = nullptr;
+};
@@ -1,6 +1,7 @@
 #include "asset_info.hpp"
 #include "cache_manager.hpp"
 #include <SDL_image.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <random>
@@ -23,8 +24,13 @@ AssetInfo::AssetInfo(const std::string& asset_folder_name)
       has_light_source(false),
       has_shading(false),
       has_base_shadow(false),
+      base_shadow_intensity(0),
       has_gradient_shadow(false),
-      has_casted_shadows(false)
+      number_of_gradient_shadows(0),
+      gradient_shadow_intensity(0),
+      has_casted_shadows(false),
+      number_of_casted_shadows(0),
+      cast_shadow_intensity(0)
 {
     name = asset_folder_name;
     dir_path_ = "SRC/" + asset_folder_name;
@@ -67,6 +73,7 @@ AssetInfo::AssetInfo(const std::string& asset_folder_name)
 
     // Lighting & shading
     load_lighting_info(data);
+    load_shading_info(data);
 
     // Size settings
     const auto& ss = data.value("size_settings", nlohmann::json::object());
@@ -93,7 +100,12 @@ AssetInfo::~AssetInfo() {
         for (SDL_Texture* tex : anim.frames) {
             if (tex) SDL_DestroyTexture(tex);
         }
+        for (SDL_Texture* tex : anim.silhouettes) {
+            if (tex) SDL_DestroyTexture(tex);
+        }
+        anim.destroy_mips();
         anim.frames.clear();
+        anim.silhouettes.clear();
     }
     animations.clear();
     child_json_paths.clear();
@@ -128,7 +140,9 @@ void AssetInfo::loadAnimations(SDL_Renderer* renderer) {
                   scaled_sprite_w,
                   scaled_sprite_h,
                   original_canvas_width,
-                  original_canvas_height);
+                  original_canvas_height,
+                  // Only shadow-mask bakes and cast shadows read silhouettes.
+                  has_shading || has_casted_shadows);
 
         if (!anim.frames.empty()) {
             animations[trigger] = std::move(anim);
@@ -138,6 +152,14 @@ void AssetInfo::loadAnimations(SDL_Renderer* renderer) {
     get_area_textures(renderer);
 }
 
+int AssetInfo::evict_unused_mips(Uint32 now_ms, Uint32 max_idle_ms) {
+    int freed = 0;
+    for (auto& [trigger, anim] : animations) {
+        freed += anim.evict_mips(now_ms, max_idle_ms);
+    }
+    return freed;
+}
+
 void AssetInfo::get_area_textures(SDL_Renderer* renderer) {
     if (!renderer) return;
 
@@ -255,6 +277,7 @@ void AssetInfo::load_lighting_info(const nlohmann::json& data) {
         light.offset_y  = l.value("offset_y", 0);
         light.x_radius  = l.value("x_radius", 0);
         light.y_radius  = l.value("y_radius", 0);
+        light.max_resolution = l.value("max_resolution", light.max_resolution);
         double factor   = l.value("factor", 100);
         light.color     = {255, 255, 255, 255};
         factor = factor/100;
@@ -298,6 +321,37 @@ void AssetInfo::load_lighting_info(const nlohmann::json& data) {
     }
 }
 
+void AssetInfo::load_shading_info(const nlohmann::json& data) {
+    has_base_shadow            = false;
+    base_shadow_intensity      = 0;
+    has_gradient_shadow        = false;
+    number_of_gradient_shadows = 0;
+    gradient_shadow_intensity  = 0;
+    has_casted_shadows         = false;
+    number_of_casted_shadows   = 0;
+    cast_shadow_intensity      = 0;
+
+    if (!data.contains("shading_info") || !data["shading_info"].is_object())
+        return;
+
+    // The asset manager writes null for fields it has no value for.
+    const auto& sinfo = data["shading_info"];
+    auto flag = [&](const char* key) {
+        return sinfo.contains(key) && sinfo[key].is_boolean() && sinfo[key].get<bool>();
+    };
+    auto number = [&](const char* key, int fallback) {
+        return (sinfo.contains(key) && sinfo[key].is_number()) ? sinfo[key].get<int>() : fallback;
+    };
+
+    has_base_shadow            = flag("has_base_shadow");
+    base_shadow_intensity      = std::clamp(number("base_shadow_intensity", 0), 0, 100);
+    has_gradient_shadow        = flag("has_gradient_shadow");
+    number_of_gradient_shadows = std::max(0, number("number_of_gradient_shadows", 1));
+    gradient_shadow_intensity  = std::clamp(number("gradient_shadow_intensity", 0), 0, 100);
+    has_casted_shadows         = flag("has_casted_shadows");
+    number_of_casted_shadows   = std::max(0, number("number_of_casted_shadows", 1));
+    cast_shadow_intensity      = std::clamp(number("cast_shadow_intensity", 0), 0, 100);
+}
 
 void AssetInfo::load_collision_areas(const nlohmann::json& data,
                                      const std::string& dir_path,
@@ -544,25 +598,24 @@ void AssetInfo::generate_lights(SDL_Renderer* renderer) {
     GenerateLight generator(renderer);
 
     for (std::size_t i = 0; i < light_sources.size(); ++i) {
-        SDL_Texture* tex = generator.generate(renderer, name, light_sources[i], i);
+        SDL_Texture* tex = generator.generate(renderer, light_sources[i]);
         if (tex) {
             SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
             light_sources[i].texture = tex;
 
-            // Cache texture size
-            SDL_QueryTexture(tex, nullptr, nullptr, &light_sources[i].cached_w, &light_sources[i].cached_h);
+            // Draw size; the texture itself may be generated at a lower resolution
+            light_sources[i].cached_w = light_sources[i].cached_h = std::max(1, light_sources[i].radius * 2);
         }
     }
 
-    std::size_t base_index = light_sources.size();
     for (std::size_t i = 0; i < orbital_light_sources.size(); ++i) {
-        SDL_Texture* tex = generator.generate(renderer, name, orbital_light_sources[i], base_index + i);
+        SDL_Texture* tex = generator.generate(renderer, orbital_light_sources[i]);
         if (tex) {
             SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
             orbital_light_sources[i].texture = tex;
 
-            // Cache texture size
-            SDL_QueryTexture(tex, nullptr, nullptr, &orbital_light_sources[i].cached_w, &orbital_light_sources[i].cached_h);
+            // Draw size; the texture itself may be generated at a lower resolution
+            orbital_light_sources[i].cached_w = orbital_light_sources[i].cached_h = std::max(1, orbital_light_sources[i].radius * 2);
         }
     }
 }
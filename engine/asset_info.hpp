@@ -28,6 +28,8 @@ public:
     ~AssetInfo();
 
     void loadAnimations(SDL_Renderer* renderer);
+    // Frees sprite mip textures idle for max_idle_ms (see Animation::evict_mips).
+    int evict_unused_mips(Uint32 now_ms, Uint32 max_idle_ms);
     bool has_tag(const std::string& tag) const;
     std::vector<LightSource> light_sources;
     std::vector<LightSource> orbital_light_sources;
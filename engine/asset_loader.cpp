@@ -1,5 +1,6 @@
 // === File: asset_loader.cpp ===
 #include "asset_loader.hpp"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <nlohmann/json.hpp>
@@ -230,6 +231,29 @@ void AssetLoader::mergeDistantAssets(const std::vector<std::vector<Asset*>>& gro
                 continue;
             }
 
+            // Keep what the group looked like so the tile can be baked later.
+            base->merged_sprites.clear();
+            base->merged_sprites.reserve(group.size());
+            for (Asset* member : group) {
+                if (!member) continue;
+                SDL_Texture* frame = member->get_current_frame();
+                if (!frame) continue;
+                MergedSprite sprite;
+                sprite.info = member->info;
+                sprite.frame = frame;
+                sprite.x = member->pos_X;
+                sprite.y = member->pos_Y;
+                SDL_QueryTexture(frame, nullptr, nullptr, &sprite.w, &sprite.h);
+                sprite.flipped = member->flipped;
+                sprite.tint_factor = member->alpha_percentage;
+                sprite.shaded = member->has_shading;
+                sprite.silhouette = member->get_current_silhouette();
+                sprite.z_index = member->z_index;
+                base->merged_sprites.push_back(std::move(sprite));
+            }
+            std::stable_sort(base->merged_sprites.begin(), base->merged_sprites.end(),
+                [](const MergedSprite& a, const MergedSprite& b) { return a.z_index < b.z_index; });
+
             // Remove all other assets in the group
             for (Asset* other : group) {
                 if (other == base) continue;
@@ -1,8 +1,22 @@
 #include "fade_textures.hpp"
+#include "pixel_kernels.hpp"
+#include "cache_manager.hpp"
+#include "hash_utils.hpp"
+#include <nlohmann/json.hpp>
 #include <cmath>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
 #include <limits>
 #include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Bump when the rasterized look changes so stale cache entries are rebuilt.
+static constexpr int FADE_CACHE_VERSION = 1;
+static constexpr int FADE_BLUR_RADIUS = 3;
 
 template <typename T>
 T clamp(T value, T min_val, T max_val) {
@@ -11,65 +25,75 @@ T clamp(T value, T min_val, T max_val) {
 
 
 
-SDL_Surface* blurSurfaceFast(SDL_Surface* src, int radius = 3) {
-    if (!src || radius <= 0) return src;
-
-    SDL_Surface* dest = SDL_ConvertSurface(src, src->format, 0);
-    if (!dest) return src;
-
-    int w = src->w, h = src->h;
-    Uint32* in = (Uint32*)src->pixels;
-    Uint32* out = (Uint32*)dest->pixels;
-    int pitch = src->pitch / 4;
-
-    std::vector<uint64_t> sumR((w+1)*(h+1), 0);
-    std::vector<uint64_t> sumG((w+1)*(h+1), 0);
-    std::vector<uint64_t> sumB((w+1)*(h+1), 0);
-    std::vector<uint64_t> sumA((w+1)*(h+1), 0);
+FadeTextureGenerator::FadeTextureGenerator(SDL_Renderer* renderer, SDL_Color color, double expand)
+    : renderer_(renderer), color_(color), expand_(expand) {}
 
-    auto idx = [&](int x, int y) { return y * (w + 1) + x; };
+static std::uint64_t fade_key(const Area& area, SDL_Color color, double expand) {
+    std::uint64_t h = HashUtils::SEED;
+    HashUtils::combine(h, static_cast<std::uint64_t>(FADE_CACHE_VERSION));
+    for (const auto& [x, y] : area.get_points()) {
+        HashUtils::combine(h, (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y));
+    }
+    HashUtils::combine(h, (std::uint64_t(color.r) << 24) | (std::uint64_t(color.g) << 16) |
+                          (std::uint64_t(color.b) << 8) | std::uint64_t(color.a));
+    HashUtils::combine(h, static_cast<std::uint64_t>(std::llround(expand * 1000.0)));
+    return h;
+}
 
-    for (int y = 1; y <= h; ++y) {
-        for (int x = 1; x <= w; ++x) {
-            Uint8 r, g, b, a;
-            SDL_GetRGBA(in[(y-1)*pitch + (x-1)], src->format, &r, &g, &b, &a);
+// Fills rgba (w * h canonical RGBA) with the fade mask: opaque inside the
+// polygon, a squared radial falloff from the area centre outside it, and the
+// base colour alpha wherever the falloff has died out. Inside-ness comes from
+// an even-odd scanline fill sampled at pixel centres.
+static void rasterize_fade(const std::vector<std::pair<double, double>>& poly,
+                           int w, int h, float cx, float cy, float fade_radius,
+                           SDL_Color color, std::vector<Uint8>& rgba)
+{
+    rgba.resize(size_t(w) * h * 4);
+    std::vector<double> crossings;
+    std::vector<Uint8> inside(static_cast<size_t>(w));
+    const size_t n = poly.size();
 
-            sumR[idx(x, y)] = r + sumR[idx(x-1, y)] + sumR[idx(x, y-1)] - sumR[idx(x-1, y-1)];
-            sumG[idx(x, y)] = g + sumG[idx(x-1, y)] + sumG[idx(x, y-1)] - sumG[idx(x-1, y-1)];
-            sumB[idx(x, y)] = b + sumB[idx(x-1, y)] + sumB[idx(x, y-1)] - sumB[idx(x-1, y-1)];
-            sumA[idx(x, y)] = a + sumA[idx(x-1, y)] + sumA[idx(x, y-1)] - sumA[idx(x-1, y-1)];
+    for (int y = 0; y < h; ++y) {
+        const double py = y + 0.5;
+
+        crossings.clear();
+        for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            const auto [xi, yi] = poly[i];
+            const auto [xj, yj] = poly[j];
+            if ((yi > py) != (yj > py)) {
+                crossings.push_back(xi + (py - yi) * (xj - xi) / (yj - yi));
+            }
         }
-    }
+        std::sort(crossings.begin(), crossings.end());
 
-    for (int y = 0; y < h; ++y) {
-        int y0 = std::max(0, y - radius);
-        int y1 = std::min(h, y + radius + 1);
+        std::fill(inside.begin(), inside.end(), Uint8(0));
+        for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+            const int x0 = std::max(0, static_cast<int>(std::ceil(crossings[k] - 0.5)));
+            const int x1 = std::min(w, static_cast<int>(std::ceil(crossings[k + 1] - 0.5)));
+            if (x0 < x1) std::fill(inside.begin() + x0, inside.begin() + x1, Uint8(1));
+        }
 
+        const float dy = static_cast<float>(py) - cy;
+        const float dy2 = dy * dy;
+        Uint8* row = &rgba[size_t(y) * w * 4];
         for (int x = 0; x < w; ++x) {
-            int x0 = std::max(0, x - radius);
-            int x1 = std::min(w, x + radius + 1);
-
-            int area = (x1 - x0) * (y1 - y0);
-            if (area == 0) area = 1;
-
-            uint64_t r = sumR[idx(x1, y1)] - sumR[idx(x0, y1)] - sumR[idx(x1, y0)] + sumR[idx(x0, y0)];
-            uint64_t g = sumG[idx(x1, y1)] - sumG[idx(x0, y1)] - sumG[idx(x1, y0)] + sumG[idx(x0, y0)];
-            uint64_t b = sumB[idx(x1, y1)] - sumB[idx(x0, y1)] - sumB[idx(x1, y0)] + sumB[idx(x0, y0)];
-            uint64_t a = sumA[idx(x1, y1)] - sumA[idx(x0, y1)] - sumA[idx(x1, y0)] + sumA[idx(x0, y0)];
-
-            out[y * pitch + x] = SDL_MapRGBA(src->format, r / area, g / area, b / area, a / area);
+            Uint8 a = color.a;
+            if (inside[x]) {
+                a = 255;
+            } else {
+                const float dx = x + 0.5f - cx;
+                const float falloff = 1.0f - clamp(std::sqrt(dx * dx + dy2) / fade_radius, 0.0f, 1.0f);
+                const float alpha = falloff * falloff; // smoother fade
+                if (alpha > 0.01f) a = static_cast<Uint8>(alpha * 255);
+            }
+            row[x * 4 + 0] = color.r;
+            row[x * 4 + 1] = color.g;
+            row[x * 4 + 2] = color.b;
+            row[x * 4 + 3] = a;
         }
     }
-
-    return dest;
 }
 
-
-
-
-FadeTextureGenerator::FadeTextureGenerator(SDL_Renderer* renderer, SDL_Color color, double expand)
-    : renderer_(renderer), color_(color), expand_(expand) {}
-
 std::vector<std::pair<SDL_Texture*, SDL_Rect>> FadeTextureGenerator::generate_all(const std::vector<Area>& areas) {
     std::vector<std::pair<SDL_Texture*, SDL_Rect>> results;
 
@@ -101,92 +125,67 @@ std::vector<std::pair<SDL_Texture*, SDL_Rect>> FadeTextureGenerator::generate_al
             ++index;
             continue;
         }
+        const SDL_Rect dst = { minx, miny, w, h };
+
+        std::ostringstream key_hex;
+        key_hex << std::hex << std::setw(16) << std::setfill('0') << fade_key(area, color_, expand_);
+        const std::string folder    = "cache/fades/" + key_hex.str();
+        const std::string meta_file = folder + "/metadata.json";
+        const std::string img_file  = folder + "/fade.png";
+
+        nlohmann::json meta;
+        if (CacheManager::load_metadata(meta_file, meta) &&
+            meta.value("version", -1) == FADE_CACHE_VERSION &&
+            meta.value("w", -1) == w && meta.value("h", -1) == h) {
+            if (SDL_Surface* cached = CacheManager::load_surface(img_file)) {
+                SDL_Texture* tex = CacheManager::surface_to_texture(renderer_, cached);
+                SDL_FreeSurface(cached);
+                if (tex) {
+                    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+                    results.emplace_back(tex, dst);
+                    std::cout << "    [FadeGen " << index << "] Loaded from cache. Size = " << w << "x" << h << "\n";
+                    ++index;
+                    continue;
+                }
+            }
+        }
 
         std::vector<std::pair<double, double>> poly;
         for (auto& [x, y] : area.get_points())
             poly.emplace_back(x - minx, y - miny);
 
-        auto point_in_poly = [&](double px, double py) {
-            bool inside = false;
-            size_t n = poly.size();
-            for (size_t i = 0, j = n - 1; i < n; j = i++) {
-                auto [xi, yi] = poly[i];
-                auto [xj, yj] = poly[j];
-                bool intersect = ((yi > py) != (yj > py)) &&
-                                 (px < (xj - xi) * (py - yi) / (yj - yi + 1e-9) + xi);
-                if (intersect) inside = !inside;
-            }
-            return inside;
-        };
+        const float fade_radius = static_cast<float>(fw + 250);
+        const float cx = static_cast<float>(ominx + ow / 2 - minx);
+        const float cy = static_cast<float>(ominy + oh / 2 - miny);
+
+        std::vector<Uint8> rgba;
+        rasterize_fade(poly, w, h, cx, cy, fade_radius, color_, rgba);
+        PixelKernels::sat_box_blur(rgba, w, h, FADE_BLUR_RADIUS);
 
-        SDL_Texture* tex = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!surf) {
+            std::cout << "    [FadeGen " << index << "] Surface creation failed; skipping.\n";
+            ++index;
+            continue;
+        }
+        PixelKernels::pack_surface(rgba, surf);
+
+        SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer_, surf);
         if (!tex) {
             std::cout << "    [FadeGen " << index << "] Texture creation failed; skipping.\n";
+            SDL_FreeSurface(surf);
             ++index;
             continue;
         }
-
         SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderTarget(renderer_, tex);
-        SDL_SetRenderDrawColor(renderer_, color_.r, color_.g, color_.b, color_.a);
-
-        SDL_RenderClear(renderer_);
+        results.emplace_back(tex, dst);
 
-        const float fade_radius = static_cast<float>(fw + 250);
-
-        const int step = 25;  // Lower resolution = ~4x faster, smooths with alpha
-
-        for (int y = 0; y < h; y += step) {
-            for (int x = 0; x < w; x += step) {
-                double gx = x + 0.5;
-                double gy = y + 0.5;
-                bool inside = point_in_poly(gx, gy);
-
-                float alpha = 0.0f;
-                if (inside) {
-                    alpha = 1.0f;
-                } else {
-                    float cx = static_cast<float>(ominx + ow / 2 - minx);
-                    float cy = static_cast<float>(ominy + oh / 2 - miny);
-                    float dx = gx - cx;
-                    float dy = gy - cy;
-                    float dist = std::sqrt(dx * dx + dy * dy);
-                    float falloff = 1.0f - clamp(dist / fade_radius, 0.0f, 1.0f);
-                    alpha = falloff * falloff; // smoother fade
-                }
-
-                if (alpha > 0.01f) {
-                    Uint8 a = static_cast<Uint8>(clamp(alpha, 0.0f, 1.0f) * 255);
-                    SDL_SetRenderDrawColor(renderer_, color_.r, color_.g, color_.b, a);
-                    for (int dy = 0; dy < step; ++dy)
-                        for (int dx = 0; dx < step; ++dx)
-                            SDL_RenderDrawPoint(renderer_, x + dx, y + dy);
-                }
-            }
+        fs::remove_all(folder);
+        fs::create_directories(folder);
+        if (CacheManager::save_surface_as_png(surf, img_file)) {
+            CacheManager::save_metadata(meta_file, { { "version", FADE_CACHE_VERSION }, { "w", w }, { "h", h } });
         }
-
-        // Step 1: Read pixels back into a surface
-        SDL_Surface* raw = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
-        SDL_SetRenderTarget(renderer_, tex);
-        SDL_RenderReadPixels(renderer_, nullptr, SDL_PIXELFORMAT_RGBA32, raw->pixels, raw->pitch);
-        SDL_SetRenderTarget(renderer_, nullptr);
-
-        // Step 2: Apply blur (radius can be tuned, e.g. 2–5)
-        SDL_Surface* blurred = blurSurfaceFast(raw, 3);
-        SDL_FreeSurface(raw);
-
-        // Step 3: Convert blurred surface back to texture
-        SDL_Texture* blurredTex = SDL_CreateTextureFromSurface(renderer_, blurred);
-        SDL_FreeSurface(blurred);
-        SDL_SetTextureBlendMode(blurredTex, SDL_BLENDMODE_BLEND);
-
-        // Step 4: Store blurred texture
-        SDL_Rect dst = { minx, miny, w, h };
-        results.emplace_back(blurredTex, dst);
-
-        // Cleanup original tex
-        SDL_DestroyTexture(tex);
-
+        SDL_FreeSurface(surf);
 
         std::cout << "    [FadeGen " << index << "] Texture stored. Size = " << w << "x" << h << "\n";
         ++index;
@@ -3,6 +3,10 @@
 #include "shadow_overlay.hpp"
 #include <cmath>
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 ShadowOverlay::ShadowOverlay(SDL_Renderer* renderer)
     : renderer_(renderer),
       main_color_({0, 0, 0, 255}),
@@ -39,66 +43,58 @@ SDL_Texture* ShadowOverlay::apply(SDL_Texture* source_texture) {
     SDL_SetTextureBlendMode(source_texture, SDL_BLENDMODE_BLEND);
     SDL_RenderCopy(renderer_, source_texture, nullptr, nullptr);
 
-    SDL_Texture* mask = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888,
-                                          SDL_TEXTUREACCESS_TARGET, w, h);
-    if (!mask) {
-        SDL_SetRenderTarget(renderer_, nullptr);
-        return result;
-    }
+    render_gradient(source_texture, SDL_Rect{0, 0, w, h});
 
-    SDL_SetTextureBlendMode(mask, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderTarget(renderer_, mask);
-    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 0);
-    SDL_RenderClear(renderer_);
-    SDL_RenderCopy(renderer_, source_texture, nullptr, nullptr);
+    SDL_SetRenderTarget(renderer_, nullptr);
+    return result;
+}
 
-    SDL_SetRenderTarget(renderer_, result);
+SDL_Color ShadowOverlay::gradient_color(float ratio) const {
+    const float inv = 1.0f - ratio;
+    SDL_Color color;
+    color.r = Uint8(main_color_.r * inv + secondary_color_.r * ratio);
+    color.g = Uint8(main_color_.g * inv + secondary_color_.g * ratio);
+    color.b = Uint8(main_color_.b * inv + secondary_color_.b * ratio);
+    color.a = Uint8(opacity_ * (intensity_ / 255.0f) * ratio);
+    return color;
+}
+
+void ShadowOverlay::render_gradient(SDL_Texture* source_texture, const SDL_Rect& dst) {
+    if (!source_texture || !renderer_ || dst.w <= 0 || dst.h <= 0) return;
 
     float rad = direction_degrees_ * (M_PI / 180.0f);
     float dx = std::cos(rad);
     float dy = std::sin(rad);
 
+    // Ratio at each corner (top-left, top-right, bottom-right, bottom-left).
+    // The gradient runs along one axis, so vertex interpolation reproduces
+    // the old per-row/per-column colour and alpha mods.
+    float ratios[4];
     if (std::fabs(dy) >= std::fabs(dx)) {
-        for (int row = 0; row < h; ++row) {
-            float raw = float(row) / float(h - 1);
-            float ratio = (dy >= 0) ? raw : 1.0f - raw;
-            float inv = 1.0f - ratio;
-
-            SDL_Color color;
-            color.r = Uint8(main_color_.r * inv + secondary_color_.r * ratio);
-            color.g = Uint8(main_color_.g * inv + secondary_color_.g * ratio);
-            color.b = Uint8(main_color_.b * inv + secondary_color_.b * ratio);
-            color.a = Uint8(opacity_ * (intensity_ / 255.0f) * ratio);
-
-            SDL_SetTextureColorMod(mask, color.r, color.g, color.b);
-            SDL_SetTextureAlphaMod(mask, color.a);
-
-            SDL_Rect line = {0, row, w, 1};
-            SDL_RenderCopy(renderer_, mask, &line, &line);
-        }
+        const float top = (dy >= 0) ? 0.0f : 1.0f;
+        ratios[0] = ratios[1] = top;
+        ratios[2] = ratios[3] = 1.0f - top;
     } else {
-        for (int col = 0; col < w; ++col) {
-            float raw = float(col) / float(w - 1);
-            float ratio = (dx >= 0) ? raw : 1.0f - raw;
-            float inv = 1.0f - ratio;
-
-            SDL_Color color;
-            color.r = Uint8(main_color_.r * inv + secondary_color_.r * ratio);
-            color.g = Uint8(main_color_.g * inv + secondary_color_.g * ratio);
-            color.b = Uint8(main_color_.b * inv + secondary_color_.b * ratio);
-            color.a = Uint8(opacity_ * (intensity_ / 255.0f) * ratio);
-
-            SDL_SetTextureColorMod(mask, color.r, color.g, color.b);
-            SDL_SetTextureAlphaMod(mask, color.a);
-
-            SDL_Rect line = {col, 0, 1, h};
-            SDL_RenderCopy(renderer_, mask, &line, &line);
-        }
+        const float left = (dx >= 0) ? 0.0f : 1.0f;
+        ratios[0] = ratios[3] = left;
+        ratios[1] = ratios[2] = 1.0f - left;
     }
 
-    SDL_DestroyTexture(mask);
-    SDL_SetRenderTarget(renderer_, nullptr);
-    return result;
+    const float x0 = float(dst.x), y0 = float(dst.y);
+    const float x1 = float(dst.x + dst.w), y1 = float(dst.y + dst.h);
+    const SDL_Vertex verts[4] = {
+        { { x0, y0 }, gradient_color(ratios[0]), { 0.0f, 0.0f } },
+        { { x1, y0 }, gradient_color(ratios[1]), { 1.0f, 0.0f } },
+        { { x1, y1 }, gradient_color(ratios[2]), { 1.0f, 1.0f } },
+        { { x0, y1 }, gradient_color(ratios[3]), { 0.0f, 1.0f } },
+    };
+    const int indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    SDL_BlendMode prev_mode;
+    SDL_GetTextureBlendMode(source_texture, &prev_mode);
+    SDL_SetTextureBlendMode(source_texture, blend_mode_);
+    SDL_RenderGeometry(renderer_, source_texture, verts, 4, indices, 6);
+    SDL_SetTextureBlendMode(source_texture, prev_mode);
 }
 
 void ShadowOverlay::set_main_color(SDL_Color color) {
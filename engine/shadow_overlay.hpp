@@ -12,6 +12,10 @@ public:
 
     SDL_Texture* apply(SDL_Texture* source_texture);
 
+    // Draws source_texture into dst on the current render target, tinted by
+    // the gradient, as one vertex-coloured quad.
+    void render_gradient(SDL_Texture* source_texture, const SDL_Rect& dst);
+
     void set_main_color(SDL_Color color);
     void set_secondary_color(SDL_Color color);
     void set_opacity(Uint8 opacity);
@@ -20,6 +24,8 @@ public:
     void set_blend_mode(SDL_BlendMode mode);
 
 private:
+    SDL_Color gradient_color(float ratio) const;
+
     SDL_Renderer* renderer_;
     SDL_Color main_color_;
     SDL_Color secondary_color_;